@@ -0,0 +1,316 @@
+#ifndef EXTERNAL_SORT_HPP
+#define EXTERNAL_SORT_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+#include "forward_list.hpp"
+#include "../common/binary_io.hpp"
+
+// External merge sort for data sets larger than memory.
+//
+// The input is a stream of records of type T in the encoding of
+// Binary_codec<T> (common/binary_io.hpp), read until end of input.
+// Records are collected into a Forward_list until the memory budget is
+// used up, that run is sorted with Forward_list::sort and spilled to a
+// temporary file, and finally the runs are merged k ways at a time with a
+// heap.  As soon as max_fan_in runs of the same length have been spilled
+// they are merged into one longer run and their files closed, so only a
+// few runs per merge level are ever open.  Equal records keep their
+// input order, as both the in-memory sort and the merge are stable.
+//
+// The 64 KiB buffers of the files count against the memory budget: a
+// merge holds one per input run and one for its output, so the fan in is
+// cut to what the budget holds, and a run leaves room for the buffer
+// that spills it.
+
+struct External_sort_options
+{
+    // bytes of list nodes (and their heap owned key storage) held in
+    // memory while a run is built, and of file buffers while merging
+    std::size_t memory_budget = std::size_t(64) << 20;
+    // largest number of runs merged in one pass, at least 2 whatever
+    // the budget
+    unsigned max_fan_in = 64;
+};
+
+// Estimated memory held by one record of a run, beyond its list node
+template <typename T>
+std::size_t external_sort_payload(const T&)
+{
+    return 0;
+}
+
+inline std::size_t external_sort_payload(const std::string& s)
+{
+    // short strings live inside the string object itself
+    return (s.capacity() > 15) ? s.capacity() + 1 : 0;
+}
+
+// A sorted run spilled to a temporary file and read back one record at a time
+template <typename T>
+class External_run
+{
+public:
+    // The file is removed by the system as soon as it is closed
+    External_run() : file_(std::tmpfile()) {}
+    ~External_run()
+    {
+        if (file_ != nullptr)
+            std::fclose(file_);
+    }
+    External_run(const External_run&) = delete;
+    External_run& operator=(const External_run&) = delete;
+
+    bool good() const { return file_ != nullptr; }
+    int fd() const { return fileno(file_); }
+
+    // number of records written to the run
+    std::uint64_t size = 0;
+
+    // prepare for reading the run from the start
+    bool rewind()
+    {
+        remaining_ = size;
+        reader_.reset();
+        if (::lseek(fd(), 0, SEEK_SET) != 0)
+            return false;
+        reader_.reset(new Binary_reader(fd()));
+        return true;
+    }
+
+    // true once every record of the run has been read
+    bool exhausted() const { return remaining_ == 0; }
+
+    // read the next record into head, the run must not be exhausted
+    // Returns false if the file is short or cannot be read, which is
+    // an error and not the end of the run.
+    // The read buffer is released with the last record.
+    bool next(T& head)
+    {
+        if (remaining_ == 0 || !Binary_codec<T>::read(*reader_, head))
+            return false;
+        if (--remaining_ == 0)
+            reader_.reset();
+        return true;
+    }
+
+private:
+    std::FILE* file_ = nullptr;
+    std::unique_ptr<Binary_reader> reader_;
+    std::uint64_t remaining_ = 0;
+};
+
+// Merges runs[first, last) in order, passing each record to emit.
+// Ties are broken by run index, which keeps the sort stable.
+// Returns false if emit or reading a run fails.
+template <typename T, typename Emit>
+bool external_merge_runs(std::vector<std::unique_ptr<External_run<T>>>& runs,
+                         std::size_t first, std::size_t last, Emit emit)
+{
+    std::vector<T> heads(last - first);
+    // heap entries are indices into heads, smallest key on top
+    auto greater = [&heads](std::size_t a, std::size_t b)
+    {
+        if (heads[b] < heads[a])
+            return true;
+        if (heads[a] < heads[b])
+            return false;
+        return a > b;
+    };
+    std::priority_queue<std::size_t, std::vector<std::size_t>, decltype(greater)> heap(greater);
+
+    for (std::size_t i = first; i < last; i++)
+    {
+        if (!runs[i]->rewind())
+            return false;
+        if (runs[i]->exhausted())
+            continue;
+        if (!runs[i]->next(heads[i - first]))
+            return false;
+        heap.push(i - first);
+    }
+    while (!heap.empty())
+    {
+        std::size_t i = heap.top();
+        heap.pop();
+        if (!emit(heads[i]))
+            return false;
+        if (runs[first + i]->exhausted())
+            continue;
+        if (!runs[first + i]->next(heads[i]))
+            return false;
+        heap.push(i);
+    }
+    return true;
+}
+
+// Merges runs[first, last) into a new run and closes their files
+// Returns nullptr if a file could not be read or written.
+template <typename T>
+std::unique_ptr<External_run<T>> external_merge_to_run(
+    std::vector<std::unique_ptr<External_run<T>>>& runs, std::size_t first, std::size_t last)
+{
+    std::unique_ptr<External_run<T>> out(new External_run<T>());
+    if (!out->good())
+        return nullptr;
+    Binary_writer writer(out->fd());
+    External_run<T>& run = *out;
+    auto write = [&writer, &run](const T& record)
+    {
+        run.size++;
+        return Binary_codec<T>::write(writer, record);
+    };
+    if (!external_merge_runs(runs, first, last, write) || !writer.flush())
+        return nullptr;
+    for (std::size_t i = first; i < last; i++)
+        runs[i].reset();
+    return out;
+}
+
+// Sorts the records of in and hands them to emit in sorted order.
+// Returns false if reading, writing or a temporary file failed, or if
+// the input ends in the middle of a record.
+template <typename T, typename Emit>
+bool external_sort_to(std::istream& in, Emit emit, const External_sort_options& options)
+{
+    Binary_reader reader(in);
+    // runs in input order, with the number of merges behind each,
+    // which never increases along the vector
+    std::vector<std::unique_ptr<External_run<T>>> runs;
+    std::vector<unsigned> levels;
+    Forward_list<T> run;
+    const std::size_t node_bytes = sizeof(typename Forward_list<T>::Node);
+    const std::size_t budget = options.memory_budget;
+
+    // a run shares the budget with the writer buffer that spills it,
+    // and a merge with its fan_in reader buffers and the writer buffer
+    const std::size_t run_budget = budget - std::min(binary_buffer_size, budget / 2);
+    const std::size_t buffers = budget / binary_buffer_size;
+    const std::size_t fan_in = std::max<std::size_t>(2, std::min<std::size_t>(
+        options.max_fan_in, (buffers > 1) ? buffers - 1 : 0));
+
+    // Phase 1: cut the input into sorted runs
+    bool input_done = false;
+    while (!input_done)
+    {
+        std::size_t used = 0;
+        // at least one record per run, however small the budget
+        while (used < run_budget || used == 0)
+        {
+            if (reader.at_end())
+            {
+                input_done = true;
+                break;
+            }
+            T record;
+            if (!Binary_codec<T>::read(reader, record))
+                return false;
+            used += node_bytes + external_sort_payload(record);
+            run.push_front(record);
+        }
+        // push_front reversed the input, put it back before the
+        // stable sort so that equal records keep their input order
+        run.reverse();
+        run.sort();
+
+        if (input_done && runs.empty())
+        {
+            // everything fitted in memory, no need for temporary files
+            for (; !run.empty(); run.pop_front())
+            {
+                if (!emit(run.front()))
+                    return false;
+            }
+            return true;
+        }
+        if (run.empty())
+            break;
+
+        runs.emplace_back(new External_run<T>());
+        External_run<T>& spill = *runs.back();
+        if (!spill.good())
+            return false;
+        Binary_writer writer(spill.fd());
+        for (; !run.empty(); run.pop_front())
+        {
+            if (!Binary_codec<T>::write(writer, run.front()))
+                return false;
+            spill.size++;
+        }
+        if (!writer.flush())
+            return false;
+        levels.push_back(0);
+
+        // merge the last fan_in runs while they are of one level
+        while (runs.size() >= fan_in && levels[levels.size() - fan_in] == levels.back())
+        {
+            const std::size_t first = runs.size() - fan_in;
+            std::unique_ptr<External_run<T>> merged = external_merge_to_run(runs, first, runs.size());
+            if (merged == nullptr)
+                return false;
+            const unsigned level = levels.back() + 1;
+            runs.resize(first);
+            levels.resize(first);
+            runs.push_back(std::move(merged));
+            levels.push_back(level);
+        }
+    }
+
+    // Phase 2: merge groups of the runs left over from the levels
+    // until one pass can finish the job
+    while (runs.size() > fan_in)
+    {
+        std::vector<std::unique_ptr<External_run<T>>> merged;
+        for (std::size_t first = 0; first < runs.size(); first += fan_in)
+        {
+            std::size_t last = std::min(runs.size(), first + fan_in);
+            merged.push_back(external_merge_to_run(runs, first, last));
+            if (merged.back() == nullptr)
+                return false;
+        }
+        runs.swap(merged);
+    }
+    return external_merge_runs(runs, 0, runs.size(), emit);
+}
+
+// Sorts the records of in and writes them to out in the same encoding
+template <typename T>
+bool external_sort(std::istream& in, std::ostream& out,
+                   const External_sort_options& options = External_sort_options())
+{
+    Binary_writer writer(out);
+    auto write = [&writer](const T& record)
+    {
+        return Binary_codec<T>::write(writer, record);
+    };
+    return external_sort_to<T>(in, write, options) && writer.flush();
+}
+
+// Sorts the records of in into out, replacing its previous contents
+// out itself must of course fit in memory
+template <typename T>
+bool external_sort(std::istream& in, Forward_list<T>& out,
+                   const External_sort_options& options = External_sort_options())
+{
+    while (!out.empty())
+        out.pop_front();
+    auto append = [&out](const T& record)
+    {
+        out.push_front(record);
+        return true;
+    };
+    bool ok = external_sort_to<T>(in, append, options);
+    out.reverse();
+    return ok;
+}
+
+#endif
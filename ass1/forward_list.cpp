@@ -3,13 +3,31 @@
 #include <vector>
 #include <forward_list>
 #include <algorithm>
+#include <cstdlib>
+#include <string>
 #include "forward_list.hpp"
 #include "tests.hpp"
 
-int main()
+// Usage
+//   forward_list_tests                               the marking tests
+//   forward_list_tests --stress [operations] [seed]  large scale differential
+//                                                    and complexity tests, best
+//                                                    built with optimisation
+int main(int argc, char** argv)
 {
+    if (argc > 1 && std::string(argv[1]) == "--stress")
+    {
+        std::size_t operations = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 1000000;
+        Tests stress_tester = (argc > 3) ? Tests(std::strtoul(argv[3], nullptr, 10)) : Tests();
+        std::cout << "seed " << stress_tester.seed() << std::endl;
+        stress_tester.test_differential(operations);
+        stress_tester.test_complexity();
+        return 0;
+    }
+
     Forward_list<int> my_list;
     Tests tester;
+    std::cout << "seed " << tester.seed() << std::endl;
     // Here are all the tests run during the marking.
     // You can uncomment them as you implement the methods
 
@@ -46,5 +64,44 @@ int main()
 
     // test_sort requires push_front, front, pop_front, copy constructor, merge and split
     tester.test_sort();
+
+    // test_save_load requires push_front, front, pop_front, save and load
+    tester.test_save_load();
+
+    // test_write requires push_front and write
+    tester.test_write();
+
+    // test_external_sort requires reverse, sort and the external_sort functions
+    tester.test_external_sort();
+
+    // test_merge_all requires push_front, front, pop_front and merge_all
+    tester.test_merge_all();
+
+    // test_stats requires push_front, pop_front and sort
+    tester.test_stats();
+
+    // test_memory_usage requires push_front and memory_usage
+    tester.test_memory_usage();
+
+    // test_radix_sort requires push_front, front, pop_front and sort
+    tester.test_radix_sort();
+
+    // test_gather_sort requires push_front, front, pop_front and sort
+    tester.test_gather_sort();
+
+    // test_set_algebra requires push_front, front, pop_front, copy
+    // constructor, unique and the set operations
+    tester.test_set_algebra();
+
+#ifdef DSA_HAS_GENERATOR
+    // test_items requires push_front, front, pop_front and items
+    tester.test_items();
+#endif
+
+    // test_small_list checks Small_forward_list against std::forward_list
+    tester.test_small_list();
+
+    // a short run of the differential test, see --stress for the full one
+    tester.test_differential(20000);
     return 0;
 }
\ No newline at end of file
@@ -3,8 +3,67 @@
 
 #include <algorithm>
 #include <iostream>
+#include <type_traits>
+#include <vector>
+#include "../common/binary_io.hpp"
+#include "../common/container_stats.hpp"
+#include "../common/generator.hpp"
+#include "../common/memory_usage.hpp"
+#include "../common/parallel_sort.hpp"
+#include "../common/text_output.hpp"
 using namespace std;
+
+// Radix_key<T> tells Forward_list::sort that T can be radix sorted.
+// key(value) must return an unsigned integer of type type that orders
+// values the same way as operator<.  It is provided for the integral
+// types, and can be specialised for any type with such a key, e.g.
+//
+//     template <> struct Radix_key<Order>
+//     {
+//         static constexpr bool enabled = true;
+//         typedef std::uint64_t type;
+//         static type key(const Order& o) { return o.id; }
+//     };
+template <typename T, typename Enable = void>
+struct Radix_key
+{
+    static constexpr bool enabled = false;
+};
+
+// bool is integral but has no unsigned counterpart, so it takes the
+// comparison sort
 template <typename T>
+struct Radix_key<T, typename std::enable_if<std::is_integral<T>::value &&
+                                            !std::is_same<T, bool>::value>::type>
+{
+    static constexpr bool enabled = true;
+    typedef typename std::make_unsigned<T>::type type;
+
+    // flipping the sign bit puts negative values before positive ones
+    static type key(T value)
+    {
+        type sign = std::is_signed<T>::value ? type(type(1) << (sizeof(T) * 8 - 1)) : type(0);
+        return static_cast<type>(static_cast<type>(value) ^ sign);
+    }
+};
+
+// How Forward_list::sort goes about sorting types without a Radix_key.
+// Lists of at least gather_threshold elements are sorted by gathering
+// their nodes into an array, sorting the array and relinking the nodes,
+// if that array and the sort's scratch space fit in memory_budget bytes.
+// Shorter lists, and lists too long for the budget, use merge_sort,
+// which needs no memory at all.
+struct Sort_options
+{
+    std::size_t gather_threshold = 64;
+    std::size_t memory_budget = std::size_t(256) << 20;
+    // threads sorting the gathered array
+    unsigned threads = 1;
+};
+
+// Stats is the statistics policy, see common/container_stats.hpp
+// The default No_stats compiles every counter away
+template <typename T, typename Stats = No_stats>
 class Forward_list
 {
 public:
@@ -42,6 +101,8 @@ private:
     // distinguish these as private member variables
     unsigned size_ = 0;
     Node* head_ = nullptr;
+    // counters of the statistics policy, takes no space for No_stats
+    [[no_unique_address]] Stats stats_;
 
 public:
     // public member functions of the Forward_list class
@@ -56,7 +117,7 @@ public:
     ~Forward_list();
 
     // Copy constructor
-    Forward_list(const Forward_list<T>& other);
+    Forward_list(const Forward_list& other);
 
     // Constructor from initializer list
     Forward_list(std::initializer_list<T> input);
@@ -73,8 +134,16 @@ public:
     T front() const;
 
     // Print out all the data in the list in sequence
+    // This goes through write, so the output is flushed only once
     void display() const;
 
+#ifdef DSA_HAS_GENERATOR
+    // The data from front to back, produced lazily, see
+    // common/generator.hpp (C++20 only)
+    // The list must not be changed while the generator is in use.
+    Generator<T> items() const;
+#endif
+
     // Outputs if the list is empty or not
     // Implemented for you
     bool empty() const;
@@ -84,12 +153,25 @@ public:
     // update the size_ member variable as needed
     unsigned size() const;
 
+    // reverse the order of the list in place
+    // no new nodes are created, only pointers change
+    void reverse();
+
     // ---------------------------------------------
     // methods related to sorting     
 
     // merge two sorted lists, *this and other
     void merge(Forward_list& other);
 
+    // merge *this and every list in lists, all of them sorted, into *this
+    // lists is any range of Forward_list<T>, for example a std::vector.
+    // A loser tree picks the next node in O(log k) comparisons for k lists,
+    // against O(k) for merging the lists pairwise one after another.
+    // Equal elements keep the order of their lists, *this first and then
+    // lists in range order.  Only pointers change and the lists end up empty.
+    template <typename Range>
+    void merge_all(Range& lists);
+
     // split *this into its first half, which becomes the new *this,
     // and its second half which is returned
     Forward_list split();
@@ -97,14 +179,123 @@ public:
     // The sort function uses the helper functions 
     // merge and split that you write
     // You do not need to modify sort itself
+    // Types with a Radix_key are instead radix sorted, see radix_sort,
+    // and long lists of other types are sorted by gather_sort, as
+    // chosen by options.  All the sorts are stable.
     void sort();
+    void sort(const Sort_options& options);
+
+    // ---------------------------------------------
+    // set algebra on sorted lists
+    // Each function is one linear pass that relinks the existing nodes
+    // of *this and other into the result, which replaces *this, and
+    // leaves other empty.  Nodes that are not part of the result are
+    // collected on the way and freed together at the end, and no node
+    // is allocated.  Duplicates follow std::set_union and friends: an
+    // element of *this and an equal one of other are matched one to one,
+    // and of a matched pair only the element of *this is kept.
+
+    // removes every element equal to the one before it, like
+    // std::forward_list::unique, which on a sorted list leaves each
+    // value once
+    void unique();
+
+    // elements in *this or in other
+    void set_union(Forward_list& other);
+
+    // elements in both *this and other
+    void set_intersection(Forward_list& other);
+
+    // elements of *this that are not in other
+    void set_difference(Forward_list& other);
+
+    // elements in exactly one of *this and other
+    void set_symmetric_difference(Forward_list& other);
+
+    // ---------------------------------------------
+    // binary serialisation, see common/binary_io.hpp
+
+    // write the list in the compact binary format: a header holding
+    // the type tag and the size, then the elements from front to back
+    // Returns false if writing failed
+    bool save(std::ostream& out) const;
+    bool save(int fd) const;
+
+    // replace the contents of the list with a list written by save
+    // The nodes are appended in file order, so no reversal is needed
+    // If the input is malformed the list is left unchanged and
+    // false is returned
+    bool load(std::istream& in);
+    bool load(int fd);
+
+    // ---------------------------------------------
+    // text output, see common/text_output.hpp
+
+    // write the elements from front to back as text, in the plain,
+    // one per line, CSV or JSON format chosen by options
+    // Returns false if writing failed
+    bool write(std::ostream& out, const Text_options& options = Text_options()) const;
+    bool write(int fd, const Text_options& options = Text_options()) const;
+
+    // ---------------------------------------------
+    // statistics, see common/container_stats.hpp
+    // With the default No_stats policy every counter reads zero
+
+    // returns the counters of this list
+    Container_stats stats() const;
+
+    // sets every counter of this list back to zero
+    void reset_stats();
+
+    // ---------------------------------------------
+    // memory footprint, see common/memory_usage.hpp
+    // O(1), or O(n) for key types that own heap memory
+    Memory_usage memory_usage() const;
 
 private:
+    bool save_to(Binary_writer& out) const;
+    bool load_from(Binary_reader& in);
+    bool write_to(Text_writer& out) const;
+
+    // frees a chain of nodes starting at n
+    void delete_chain(Node* n);
+
+    // the pass behind the set algebra functions: the keep flags say
+    // whether an element only in *this, only in other, or matched by
+    // an equal element of other goes into the result
+    void set_operation(Forward_list& other, bool keep_only_this,
+                       bool keep_only_other, bool keep_matched);
 
     // sort is implemented via a recursive merge sort
     // You do not need to modify this function
     void merge_sort(Forward_list&);
 
+    // LSD radix sort for types with a Radix_key, one pass per 11 bit
+    // digit of the key.  Each pass deals the nodes out to 2048 buckets
+    // in list order, which keeps it stable, and joins the buckets again.
+    // Only next pointers change, and digits that are equal in every key
+    // are skipped.  O(n w) for w bit keys, with no comparisons at all.
+    void radix_sort();
+
+    // Sorts an array of pointers to the nodes and relinks the nodes in
+    // the order of the array, one pass each way, so the sort itself
+    // runs over contiguous memory instead of chasing next pointers.
+    // Small trivially copyable keys are copied into the array next to
+    // their node pointers, so that comparisons do not touch the nodes.
+    // With a counting statistics policy a single thread is used, which
+    // keeps the counters exact.
+    void gather_sort(unsigned threads);
+
+    // an element of gather_sort's array for small keys
+    struct Gather_entry
+    {
+        T key;
+        Node* node;
+    };
+
+    // bytes gather_sort needs for a list of this length
+    std::size_t gather_bytes() const;
+
     // display helpful information about a node
     // used for debugging
     void displayNode(Node* n);
@@ -113,8 +304,8 @@ private:
 
 // Default Constructor
 // You do not need to change this
-template <typename T>
-Forward_list<T>::Forward_list()
+template <typename T, typename Stats>
+Forward_list<T, Stats>::Forward_list()
 {
     size_ = 0;
     head_ = nullptr;
@@ -122,14 +313,15 @@ Forward_list<T>::Forward_list()
 
 // Destructor
 // The destructor is implemented for you
-template <typename T>
-Forward_list<T>::~Forward_list()
+template <typename T, typename Stats>
+Forward_list<T, Stats>::~Forward_list()
 {
     while(head_ != nullptr)
     {
         Node* tmp = head_;
         head_ = head_->next;
         delete tmp;
+        stats_.free();
         --size_;
     }
 }
@@ -142,14 +334,15 @@ Forward_list<T>::~Forward_list()
 // The function should make a "deep copy" of the other list,
 // that is create a new node for every node in other and copy 
 // the data of other into these new nodes.  
-template <typename T>
-Forward_list<T>::Forward_list(const Forward_list& other)
+template <typename T, typename Stats>
+Forward_list<T, Stats>::Forward_list(const Forward_list& other)
 {
     if (other.head_ == nullptr)
         return;
     
     // Create the first node with the head data of other
     Node* n_this = new Node(other.head_->data, nullptr);
+    stats_.allocation();
     // Set this node as the head of self
     this->head_ = n_this;
     this->size_++;
@@ -163,6 +356,7 @@ Forward_list<T>::Forward_list(const Forward_list& other)
         n_oth = n_oth->next;
         // Create a new node that copies the data from the other node
         Node* new_node = new Node();
+        stats_.allocation();
         new_node->data = n_oth->data;
         // Mark new node as the next of our list
         n_this->next = new_node;
@@ -183,8 +377,8 @@ Forward_list<T>::Forward_list(const Forward_list& other)
 // see this is the argument to this constructor (with data of type T
 // rather than just int). 
 
-template <typename T>
-Forward_list<T>::Forward_list(std::initializer_list<T> input)
+template <typename T, typename Stats>
+Forward_list<T, Stats>::Forward_list(std::initializer_list<T> input)
 {
     // Add the values in backwards so that the front node has the first
     // value from the initializer list
@@ -196,11 +390,12 @@ Forward_list<T>::Forward_list(std::initializer_list<T> input)
 
 
 // Add element to front of list
-template <typename T>
-void Forward_list<T>::push_front(const T& data)
+template <typename T, typename Stats>
+void Forward_list<T, Stats>::push_front(const T& data)
 {
     // Create a new node that links with the front
     Node* new_node = new Node(data,this->head_);
+    stats_.allocation();
     // Update the front node and size
     this->head_ = new_node;
     this->size_++;
@@ -208,8 +403,8 @@ void Forward_list<T>::push_front(const T& data)
 
 // Remove the front element of the list 
 // If the list is empty don't do anything
-template <typename T>
-void Forward_list<T>::pop_front()
+template <typename T, typename Stats>
+void Forward_list<T, Stats>::pop_front()
 {
     if (this->head_ != nullptr)
     {
@@ -219,6 +414,7 @@ void Forward_list<T>::pop_front()
         this->head_ = this->head_->next;
         // displayNode(tmp);
         delete tmp;
+        stats_.free();
         this->size_--;
     }
 }
@@ -226,8 +422,8 @@ void Forward_list<T>::pop_front()
 // Return the data in the front element of the list
 // If the list is empty the behaviour is undefined:
 // you can return an arbitrary value, but don't segfault 
-template <typename T>
-T Forward_list<T>::front() const
+template <typename T, typename Stats>
+T Forward_list<T, Stats>::front() const
 {
     // Return the front value unless the list is empty
     if (this->head_ != nullptr)
@@ -239,24 +435,28 @@ T Forward_list<T>::front() const
 }
 
 // Print out the list
-template <typename T>
-void Forward_list<T>::display() const
+template <typename T, typename Stats>
+void Forward_list<T, Stats>::display() const
 {
-    // Traverse the list and print along the way
-    Node* tmp = this->head_;
-    while (tmp != nullptr)
+    this->write(std::cout);
+}
+
+#ifdef DSA_HAS_GENERATOR
+template <typename T, typename Stats>
+Generator<T> Forward_list<T, Stats>::items() const
+{
+    for (Node* tmp = this->head_; tmp != nullptr; tmp = tmp->next)
     {
-        std::cout << tmp->data << " ";
-        tmp = tmp->next;
+        co_yield tmp->data;
     }
-    std::cout << endl;
 }
+#endif
 
 
 // Outputs if the list is empty or not
 // Implemented for you
-template <typename T>
-bool Forward_list<T>::empty() const
+template <typename T, typename Stats>
+bool Forward_list<T, Stats>::empty() const
 {
     return (head_ == nullptr);
 }
@@ -266,13 +466,30 @@ bool Forward_list<T>::empty() const
 // update the size_ variable in your code as needed
 
 // Note that std::forward_list actually does not have a size function
-template <typename T>
-unsigned Forward_list<T>::size() const
+template <typename T, typename Stats>
+unsigned Forward_list<T, Stats>::size() const
 {
     return size_;
 }
 
 
+// Reverse the list by turning every next pointer around
+template <typename T, typename Stats>
+void Forward_list<T, Stats>::reverse()
+{
+    Node* prev = nullptr;
+    Node* tmp = this->head_;
+    while (tmp != nullptr)
+    {
+        Node* next = tmp->next;
+        tmp->next = prev;
+        stats_.relink();
+        prev = tmp;
+        tmp = next;
+    }
+    this->head_ = prev;
+}
+
 // the split function splits *this into its first half, which becomes 
 // the new *this, and its second half which is returned
 // if the the size of *this is n, then after split the size of *this 
@@ -289,8 +506,8 @@ unsigned Forward_list<T>::size() const
 // Don't forget to update the size_ variable of this and other
 // You do not need to create any new nodes for this function,
 // just change pointers.
-template <typename T>
-Forward_list<T> Forward_list<T>::split()
+template <typename T, typename Stats>
+Forward_list<T, Stats> Forward_list<T, Stats>::split()
 {
     // Minimum length for splitting must be 2
     if (this->size_ < 2)
@@ -309,15 +526,17 @@ Forward_list<T> Forward_list<T>::split()
     {
         tmp = tmp->next;
     }
+    stats_.visit(mid + 1);
     // At this point, tmp holds the final node of this
     // tmp->next will be the first node of other
 
-    Forward_list<T> other = Forward_list();
+    Forward_list other;
     other.head_ = tmp->next;
     other.size_ = this->size_ / 2;
 
     // Update this list end value and size
     tmp->next = nullptr;
+    stats_.relink();
     this->size_ = (this->size_ + 1)/2;
 
     return other;
@@ -325,8 +544,8 @@ Forward_list<T> Forward_list<T>::split()
 
 // Display information about a node
 // Useful function for debugging
-template <typename T>
-void Forward_list<T>::displayNode(Node* n)
+template <typename T, typename Stats>
+void Forward_list<T, Stats>::displayNode(Node* n)
 {
     cout << "data: " << n->data << " adress: " << n << " n->next: " << n->next << endl;
 }
@@ -340,8 +559,8 @@ void Forward_list<T>::displayNode(Node* n)
 // You do not need to create any new nodes in this function,
 // just update pointers.  
 // Set other to be an empty list at the end of the function
-template <typename T>
-void Forward_list<T>::merge(Forward_list& other)
+template <typename T, typename Stats>
+void Forward_list<T, Stats>::merge(Forward_list& other)
 {
 
     Node* n_other = other.head_;
@@ -361,7 +580,8 @@ void Forward_list<T>::merge(Forward_list& other)
         return;
 
     // Header select
-    if (n_this->data > n_other->data)
+    stats_.comparison();
+    if (n_other->data < n_this->data)
     {
         n_merged = n_other; 
         n_other = n_other->next;
@@ -396,6 +616,7 @@ void Forward_list<T>::merge(Forward_list& other)
         // If neither is depleted, compare and choose the next value
         else if (n_this != nullptr && n_other != nullptr)
         {
+            stats_.comparison();
             if (n_other->data < n_this->data)
             {
                 n_merged->next = n_other;
@@ -415,6 +636,7 @@ void Forward_list<T>::merge(Forward_list& other)
             break;
         
         // Always advance n_merged
+        stats_.relink();
         n_merged = n_merged->next;
     }
     // Kill the other list
@@ -423,30 +645,532 @@ void Forward_list<T>::merge(Forward_list& other)
 
 }   
 
+// k way merge with a loser tree
+// Source 0 is *this, source i > 0 is the i-th list of lists.
+// heads[i] is the first unmerged node of source i.  The tree has the
+// sources as leaves k..2k-1, every internal node 1..k-1 holds the
+// loser of the match played there and tree[0] holds the overall winner.
+// After the winner's node is moved to the merged list only the matches
+// on the path from its leaf to the root have to be replayed.
+template <typename T, typename Stats>
+template <typename Range>
+void Forward_list<T, Stats>::merge_all(Range& lists)
+{
+    std::vector<Node*> heads;
+    heads.push_back(this->head_);
+    for (Forward_list& other : lists)
+    {
+        if (&other == this)
+            continue;
+        heads.push_back(other.head_);
+        this->size_ += other.size_;
+        other.head_ = nullptr;
+        other.size_ = 0;
+    }
+    const std::size_t k = heads.size();
+
+    // true if source a wins against source b
+    // exhausted sources lose, ties go to the earlier source
+    auto beats = [this, &heads](std::size_t a, std::size_t b)
+    {
+        if (heads[a] == nullptr || heads[b] == nullptr)
+            return heads[b] == nullptr && (heads[a] != nullptr || a < b);
+        stats_.comparison();
+        if (heads[a]->data < heads[b]->data)
+            return true;
+        stats_.comparison();
+        if (heads[b]->data < heads[a]->data)
+            return false;
+        return a < b;
+    };
+
+    // Build the tree by sending every source up from its leaf.
+    // The first source to reach a node waits there, the second one
+    // plays it, the loser stays and the winner carries on upwards.
+    const std::size_t empty = k;
+    std::vector<std::size_t> tree(k, empty);
+    for (std::size_t i = 0; i < k; i++)
+    {
+        std::size_t winner = i;
+        std::size_t node = (i + k) / 2;
+        while (node > 0)
+        {
+            if (tree[node] == empty)
+            {
+                tree[node] = winner;
+                break;
+            }
+            if (beats(tree[node], winner))
+                std::swap(tree[node], winner);
+            node /= 2;
+        }
+        if (node == 0)
+            tree[0] = winner;
+    }
+
+    Node* merged_head = nullptr;
+    Node* tail = nullptr;
+    while (heads[tree[0]] != nullptr)
+    {
+        std::size_t winner = tree[0];
+        Node* n = heads[winner];
+        heads[winner] = n->next;
+        if (tail == nullptr)
+            merged_head = n;
+        else
+            tail->next = n;
+        tail = n;
+        stats_.relink();
+
+        // replay the matches on the winner's path
+        for (std::size_t node = (winner + k) / 2; node > 0; node /= 2)
+        {
+            if (beats(tree[node], winner))
+                std::swap(tree[node], winner);
+        }
+        tree[0] = winner;
+    }
+    this->head_ = merged_head;
+}
+
 // recursive implementation of merge_sort
 // you do not need to change this function
-template <typename T>
-void Forward_list<T>::merge_sort(Forward_list& my_list)
+template <typename T, typename Stats>
+void Forward_list<T, Stats>::merge_sort(Forward_list& my_list)
 {
     if(my_list.size() == 0 || my_list.size() == 1)
     {
         return;
     }
-    Forward_list<T> second = my_list.split();
+    Forward_list second = my_list.split();
     merge_sort(my_list);
     merge_sort(second);
     my_list.merge(second);
+    // second sorted itself on its own counters
+    my_list.stats_.add(second.stats_);
 }
 
 // sorts the list by calling merge_sort
 // once your merge and split functions are working
 // sort should automatically work
 // you do not need to change this function
+template <typename T, typename Stats>
+void Forward_list<T, Stats>::sort()
+{
+    sort(Sort_options());
+}
+
+template <typename T, typename Stats>
+void Forward_list<T, Stats>::sort(const Sort_options& options)
+{
+    if constexpr (Radix_key<T>::enabled)
+        radix_sort();
+    else if (this->size_ >= options.gather_threshold &&
+             gather_bytes() <= options.memory_budget)
+        gather_sort(options.threads);
+    else
+        merge_sort(*this);
+}
+
+// keys no larger than a pointer are gathered next to their node
 template <typename T>
-void Forward_list<T>::sort()
+struct Gather_key
+{
+    static constexpr bool enabled =
+        std::is_trivially_copyable<T>::value && sizeof(T) <= sizeof(void*);
+};
+
+template <typename T, typename Stats>
+std::size_t Forward_list<T, Stats>::gather_bytes() const
+{
+    // the array, plus as much again for the scratch space of
+    // std::stable_sort and std::inplace_merge
+    // sizeof the entry, which counts its padding
+    std::size_t entry = Gather_key<T>::enabled ? sizeof(Gather_entry) : sizeof(Node*);
+    return 2 * entry * this->size_;
+}
+
+template <typename T, typename Stats>
+void Forward_list<T, Stats>::gather_sort(unsigned threads)
+{
+    if (this->size_ < 2)
+        return;
+    if (Stats::enabled)
+        threads = 1;
+    // links the nodes in the order of entries, node_of(entry) being
+    // the node of an entry
+    auto relink = [this](const auto& entries, auto node_of)
+    {
+        for (std::size_t i = 0; i + 1 < entries.size(); i++)
+            node_of(entries[i])->next = node_of(entries[i + 1]);
+        node_of(entries.back())->next = nullptr;
+        this->head_ = node_of(entries.front());
+        stats_.visit(this->size_);
+        stats_.relink(this->size_);
+    };
+
+    if constexpr (Gather_key<T>::enabled)
+    {
+        std::vector<Gather_entry> entries;
+        entries.reserve(this->size_);
+        for (Node* n = this->head_; n != nullptr; n = n->next)
+            entries.push_back(Gather_entry {n->data, n});
+        parallel_stable_sort(entries.begin(), entries.end(),
+            [this](const Gather_entry& a, const Gather_entry& b)
+            {
+                stats_.comparison();
+                return a.key < b.key;
+            }, threads);
+        relink(entries, [](const Gather_entry& e) { return e.node; });
+    }
+    else
+    {
+        std::vector<Node*> nodes;
+        nodes.reserve(this->size_);
+        for (Node* n = this->head_; n != nullptr; n = n->next)
+            nodes.push_back(n);
+        parallel_stable_sort(nodes.begin(), nodes.end(),
+            [this](const Node* a, const Node* b)
+            {
+                stats_.comparison();
+                return a->data < b->data;
+            }, threads);
+        relink(nodes, [](Node* n) { return n; });
+    }
+}
+
+template <typename T, typename Stats>
+void Forward_list<T, Stats>::radix_sort()
+{
+    typedef typename Radix_key<T>::type Key;
+    if (this->size_ < 2)
+        return;
+
+    // find the bits that differ between keys
+    Key all_and = static_cast<Key>(~Key(0));
+    Key all_or = 0;
+    for (Node* n = this->head_; n != nullptr; n = n->next)
+    {
+        Key key = Radix_key<T>::key(n->data);
+        all_and &= key;
+        all_or |= key;
+    }
+    stats_.visit(this->size_);
+    const Key varying = all_and ^ all_or;
+
+    // 11 bit digits: three passes for 32 bit keys, and the 2048
+    // bucket heads and tails still fit in the first level cache
+    const unsigned bits = 11;
+    const unsigned buckets = 1u << bits;
+    Node* heads[buckets];
+    Node** tails[buckets];
+    for (unsigned shift = 0; shift < sizeof(Key) * 8; shift += bits)
+    {
+        if (((varying >> shift) & (buckets - 1)) == 0)
+            continue;
+        for (unsigned d = 0; d < buckets; d++)
+        {
+            heads[d] = nullptr;
+            tails[d] = &heads[d];
+        }
+        for (Node* n = this->head_; n != nullptr; n = n->next)
+        {
+            unsigned d = (Radix_key<T>::key(n->data) >> shift) & (buckets - 1);
+            *tails[d] = n;
+            tails[d] = &n->next;
+        }
+        Node** tail = &this->head_;
+        for (unsigned d = 0; d < buckets; d++)
+        {
+            if (heads[d] != nullptr)
+            {
+                *tail = heads[d];
+                tail = tails[d];
+            }
+        }
+        *tail = nullptr;
+        stats_.relink(this->size_);
+    }
+}
+
+// Set algebra on sorted lists
+
+template <typename T, typename Stats>
+void Forward_list<T, Stats>::unique()
+{
+    if (this->head_ == nullptr)
+        return;
+    Node* kept = this->head_;
+    Node* discarded = nullptr;
+    Node* next = nullptr;
+    for (Node* n = kept->next; n != nullptr; n = next)
+    {
+        next = n->next;
+        stats_.comparison();
+        if (kept->data < n->data || n->data < kept->data)
+        {
+            kept->next = n;
+            kept = n;
+        }
+        else
+        {
+            n->next = discarded;
+            discarded = n;
+            this->size_--;
+        }
+    }
+    kept->next = nullptr;
+    delete_chain(discarded);
+}
+
+template <typename T, typename Stats>
+void Forward_list<T, Stats>::set_union(Forward_list& other)
+{
+    set_operation(other, true, true, true);
+}
+
+template <typename T, typename Stats>
+void Forward_list<T, Stats>::set_intersection(Forward_list& other)
 {
-    merge_sort(*this);
+    set_operation(other, false, false, true);
 }
 
+template <typename T, typename Stats>
+void Forward_list<T, Stats>::set_difference(Forward_list& other)
+{
+    set_operation(other, true, false, false);
+}
+
+template <typename T, typename Stats>
+void Forward_list<T, Stats>::set_symmetric_difference(Forward_list& other)
+{
+    set_operation(other, true, true, false);
+}
+
+// Walks both lists like merge.  The smaller head is an element only in
+// its own list, equal heads are a matched pair.  Whatever remains of
+// one list after the other runs out is only in that list.
+template <typename T, typename Stats>
+void Forward_list<T, Stats>::set_operation(Forward_list& other, bool keep_only_this,
+                                           bool keep_only_other, bool keep_matched)
+{
+    if (this == &other)
+        return;
+    Node* a = this->head_;
+    Node* b = other.head_;
+    Node** tail = &this->head_;
+    Node* discarded = nullptr;
+    unsigned size = 0;
+    auto take = [&](Node* n, bool keep)
+    {
+        if (keep)
+        {
+            *tail = n;
+            tail = &n->next;
+            size++;
+        }
+        else
+        {
+            n->next = discarded;
+            discarded = n;
+        }
+    };
+
+    while (a != nullptr && b != nullptr)
+    {
+        Node* next_a = a->next;
+        Node* next_b = b->next;
+        stats_.comparison();
+        if (a->data < b->data)
+        {
+            take(a, keep_only_this);
+            a = next_a;
+        }
+        else if (b->data < a->data)
+        {
+            take(b, keep_only_other);
+            b = next_b;
+        }
+        else
+        {
+            take(a, keep_matched);
+            take(b, false);
+            a = next_a;
+            b = next_b;
+        }
+    }
+    // a remainder that is kept is linked on whole
+    if (a != nullptr && keep_only_this)
+    {
+        *tail = a;
+        for (; a != nullptr; a = a->next)
+            size++;
+    }
+    else if (b != nullptr && keep_only_other)
+    {
+        *tail = b;
+        for (; b != nullptr; b = b->next)
+            size++;
+    }
+    else
+    {
+        *tail = nullptr;
+        delete_chain(a != nullptr ? a : b);
+    }
+    stats_.relink(size);
+
+    this->size_ = size;
+    other.head_ = nullptr;
+    other.size_ = 0;
+    delete_chain(discarded);
+}
+
+// Binary serialisation
+
+template <typename T, typename Stats>
+bool Forward_list<T, Stats>::save(std::ostream& out) const
+{
+    Binary_writer writer(out);
+    return save_to(writer) && writer.flush();
+}
+
+template <typename T, typename Stats>
+bool Forward_list<T, Stats>::save(int fd) const
+{
+    Binary_writer writer(fd);
+    return save_to(writer) && writer.flush();
+}
+
+template <typename T, typename Stats>
+bool Forward_list<T, Stats>::load(std::istream& in)
+{
+    Binary_reader reader(in);
+    return load_from(reader);
+}
+
+template <typename T, typename Stats>
+bool Forward_list<T, Stats>::load(int fd)
+{
+    Binary_reader reader(fd);
+    return load_from(reader);
+}
+
+// Text output
+
+template <typename T, typename Stats>
+bool Forward_list<T, Stats>::write(std::ostream& out, const Text_options& options) const
+{
+    Text_writer writer(out, options);
+    return write_to(writer);
+}
+
+template <typename T, typename Stats>
+bool Forward_list<T, Stats>::write(int fd, const Text_options& options) const
+{
+    Text_writer writer(fd, options);
+    return write_to(writer);
+}
+
+template <typename T, typename Stats>
+bool Forward_list<T, Stats>::write_to(Text_writer& out) const
+{
+    out.begin();
+    for (Node* n = this->head_; n != nullptr; n = n->next)
+    {
+        if (!out.element(n->data))
+            return false;
+    }
+    return out.finish();
+}
+
+template <typename T, typename Stats>
+bool Forward_list<T, Stats>::save_to(Binary_writer& out) const
+{
+    if (!write_binary_header<T>(out, "DSAL", this->size_))
+        return false;
+    for (Node* n = this->head_; n != nullptr; n = n->next)
+    {
+        if (!Binary_codec<T>::write(out, n->data))
+            return false;
+    }
+    return true;
+}
+
+template <typename T, typename Stats>
+bool Forward_list<T, Stats>::load_from(Binary_reader& in)
+{
+    std::uint64_t count = 0;
+    if (!read_binary_header<T>(in, "DSAL", count))
+        return false;
+
+    // Build the new chain on the side so that a failed load
+    // does not touch the current contents
+    Node* head = nullptr;
+    Node* tail = nullptr;
+    for (std::uint64_t i = 0; i < count; i++)
+    {
+        Node* new_node = new Node();
+        stats_.allocation();
+        if (!Binary_codec<T>::read(in, new_node->data))
+        {
+            delete new_node;
+            delete_chain(head);
+            return false;
+        }
+        if (tail == nullptr)
+            head = new_node;
+        else
+            tail->next = new_node;
+        tail = new_node;
+    }
+
+    delete_chain(this->head_);
+    this->head_ = head;
+    this->size_ = count;
+    return true;
+}
+
+template <typename T, typename Stats>
+void Forward_list<T, Stats>::delete_chain(Node* n)
+{
+    while (n != nullptr)
+    {
+        Node* tmp = n;
+        n = n->next;
+        delete tmp;
+        stats_.free();
+    }
+}
+
+// Statistics
+
+template <typename T, typename Stats>
+Container_stats Forward_list<T, Stats>::stats() const
+{
+    return stats_.snapshot();
+}
+
+template <typename T, typename Stats>
+void Forward_list<T, Stats>::reset_stats()
+{
+    stats_.reset();
+}
+
+// Memory footprint
+
+template <typename T, typename Stats>
+Memory_usage Forward_list<T, Stats>::memory_usage() const
+{
+    Memory_usage m = node_memory_usage<Node, T>(this->size_, sizeof(Node*), 0);
+    add_container_bytes(m, sizeof(*this));
+    if constexpr (Heap_usage<T>::enabled)
+    {
+        for (Node* n = this->head_; n != nullptr; n = n->next)
+        {
+            add_heap_usage(m, n->data);
+        }
+    }
+    return m;
+}
 
-#endif
\ No newline at end of file
+#endif
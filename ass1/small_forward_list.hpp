@@ -0,0 +1,410 @@
+#ifndef SMALL_FORWARD_LIST_HPP
+#define SMALL_FORWARD_LIST_HPP
+
+#include <functional>
+#include <initializer_list>
+#include <iostream>
+#include <new>
+#include <utility>
+
+// A Forward_list that keeps its first N nodes inside the list object.
+// push_front takes a node from the inline slots while one is free and
+// only allocates on the heap past that, so short lists never touch the
+// allocator.  Inline and heap nodes can be mixed freely in one chain.
+//
+// An inline node belongs to the storage of one particular list, so any
+// operation that hands nodes from one list to another (move, merge,
+// split) moves the data of the other list's inline nodes into nodes of
+// the receiving list.  Heap nodes are still passed on by relinking.
+// sort relinks in place and never moves data.
+template <typename T, unsigned N = 8>
+class Small_forward_list
+{
+    static_assert(N > 0, "use Forward_list for lists without inline nodes");
+
+public:
+    class Node
+    {
+    public:
+        T data;
+        Node* next = nullptr;
+
+        Node(const T& input_data, Node* next_node = nullptr)
+            : data(input_data), next(next_node) {}
+        Node(T&& input_data, Node* next_node = nullptr)
+            : data(std::move(input_data)), next(next_node) {}
+    };
+
+private:
+    // An inline slot holds a node while it is in use and
+    // the link of the list of free slots otherwise
+    union Slot
+    {
+        Slot() {}
+        ~Slot() {}
+        Node node;
+        Slot* next_free;
+    };
+
+    unsigned size_ = 0;
+    Node* head_ = nullptr;
+    // slots_[fresh_, N) have never been used, slots given
+    // back by pop_front and friends are kept on free_
+    unsigned fresh_ = 0;
+    Slot* free_ = nullptr;
+    Slot slots_[N];
+
+public:
+    Small_forward_list() {}
+    ~Small_forward_list();
+
+    Small_forward_list(const Small_forward_list& other);
+    Small_forward_list(Small_forward_list&& other);
+    Small_forward_list(std::initializer_list<T> input);
+
+    Small_forward_list& operator=(const Small_forward_list& other);
+    Small_forward_list& operator=(Small_forward_list&& other);
+
+    // Same meaning as the corresponding functions of Forward_list
+    void push_front(const T& data);
+    void pop_front();
+    T front() const;
+    void display() const;
+    bool empty() const;
+    unsigned size() const;
+
+    // merge two sorted lists, *this and other, into *this
+    // Equal elements of *this come before those of other
+    void merge(Small_forward_list& other);
+
+    // split *this into its first half, which becomes the new *this,
+    // and its second half which is returned
+    Small_forward_list split();
+
+    // stable bottom-up merge sort that only relinks nodes
+    void sort();
+
+    // true if n is one of the inline nodes of this list
+    bool is_inline(const Node* n) const;
+
+private:
+    // takes an inline slot, or a heap node once all are in use
+    template <typename U>
+    Node* make_node(U&& data, Node* next);
+
+    // gives an inline slot back or deletes a heap node
+    void destroy_node(Node* n);
+
+    void clear();
+
+    // appends copies of the nodes of chain to the end of this list
+    void copy_chain(const Node* chain);
+
+    // Takes over chain, whose nodes so far belonged to from.
+    // Nodes inline in from are moved into nodes of this list,
+    // heap nodes are kept.  Returns the new head of the chain.
+    Node* adopt(Small_forward_list& from, Node* chain);
+
+    // stable merge of two sorted chains, a first on ties
+    static Node* merge_chains(Node* a, Node* b);
+};
+
+template <typename T, unsigned N>
+Small_forward_list<T, N>::~Small_forward_list()
+{
+    clear();
+}
+
+template <typename T, unsigned N>
+Small_forward_list<T, N>::Small_forward_list(const Small_forward_list& other)
+{
+    copy_chain(other.head_);
+}
+
+template <typename T, unsigned N>
+Small_forward_list<T, N>::Small_forward_list(Small_forward_list&& other)
+{
+    this->head_ = adopt(other, other.head_);
+    this->size_ = other.size_;
+    other.head_ = nullptr;
+    other.size_ = 0;
+}
+
+template <typename T, unsigned N>
+Small_forward_list<T, N>::Small_forward_list(std::initializer_list<T> input)
+{
+    Node** tail = &this->head_;
+    for (const T& data : input)
+    {
+        *tail = make_node(data, nullptr);
+        tail = &(*tail)->next;
+        this->size_++;
+    }
+}
+
+template <typename T, unsigned N>
+Small_forward_list<T, N>& Small_forward_list<T, N>::operator=(const Small_forward_list& other)
+{
+    if (this != &other)
+    {
+        clear();
+        copy_chain(other.head_);
+    }
+    return *this;
+}
+
+template <typename T, unsigned N>
+Small_forward_list<T, N>& Small_forward_list<T, N>::operator=(Small_forward_list&& other)
+{
+    if (this != &other)
+    {
+        clear();
+        this->head_ = adopt(other, other.head_);
+        this->size_ = other.size_;
+        other.head_ = nullptr;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+template <typename T, unsigned N>
+void Small_forward_list<T, N>::push_front(const T& data)
+{
+    this->head_ = make_node(data, this->head_);
+    this->size_++;
+}
+
+template <typename T, unsigned N>
+void Small_forward_list<T, N>::pop_front()
+{
+    if (this->head_ != nullptr)
+    {
+        Node* tmp = this->head_;
+        this->head_ = tmp->next;
+        destroy_node(tmp);
+        this->size_--;
+    }
+}
+
+template <typename T, unsigned N>
+T Small_forward_list<T, N>::front() const
+{
+    // as Forward_list, an empty list gives T()
+    if (this->head_ != nullptr)
+    {
+        return this->head_->data;
+    }
+    return T();
+}
+
+template <typename T, unsigned N>
+void Small_forward_list<T, N>::display() const
+{
+    for (Node* tmp = this->head_; tmp != nullptr; tmp = tmp->next)
+    {
+        std::cout << tmp->data << " ";
+    }
+    std::cout << std::endl;
+}
+
+template <typename T, unsigned N>
+bool Small_forward_list<T, N>::empty() const
+{
+    return this->head_ == nullptr;
+}
+
+template <typename T, unsigned N>
+unsigned Small_forward_list<T, N>::size() const
+{
+    return this->size_;
+}
+
+template <typename T, unsigned N>
+void Small_forward_list<T, N>::merge(Small_forward_list& other)
+{
+    if (this == &other)
+        return;
+    Node* theirs = adopt(other, other.head_);
+    this->head_ = merge_chains(this->head_, theirs);
+    this->size_ += other.size_;
+    other.head_ = nullptr;
+    other.size_ = 0;
+}
+
+template <typename T, unsigned N>
+Small_forward_list<T, N> Small_forward_list<T, N>::split()
+{
+    Small_forward_list other;
+    // Minimum length for splitting must be 2
+    if (this->size_ < 2)
+        return other;
+
+    // the first half keeps the extra node of an odd length list
+    unsigned first_size = (this->size_ + 1) / 2;
+    Node* tmp = this->head_;
+    for (unsigned i = 1; i < first_size; i++)
+    {
+        tmp = tmp->next;
+    }
+    Node* rest = tmp->next;
+    tmp->next = nullptr;
+
+    other.head_ = other.adopt(*this, rest);
+    other.size_ = this->size_ - first_size;
+    this->size_ = first_size;
+    return other;
+}
+
+// Bottom-up merge sort, as used by std::list implementations.
+// bins[i] holds a sorted run of 2^i nodes, or nothing.  Each node
+// is merged in like a carry in binary addition.  Runs in higher bins
+// hold earlier nodes, which are passed first to merge_chains so that
+// equal elements keep their order.
+template <typename T, unsigned N>
+void Small_forward_list<T, N>::sort()
+{
+    Node* bins[64] = {};
+    unsigned used = 0;
+    Node* n = this->head_;
+    while (n != nullptr)
+    {
+        Node* next = n->next;
+        n->next = nullptr;
+        Node* run = n;
+        unsigned i = 0;
+        for (; i < used && bins[i] != nullptr; i++)
+        {
+            run = merge_chains(bins[i], run);
+            bins[i] = nullptr;
+        }
+        bins[i] = run;
+        if (i == used)
+            used++;
+        n = next;
+    }
+    Node* result = nullptr;
+    for (unsigned i = 0; i < used; i++)
+    {
+        if (bins[i] != nullptr)
+            result = merge_chains(bins[i], result);
+    }
+    this->head_ = result;
+}
+
+template <typename T, unsigned N>
+bool Small_forward_list<T, N>::is_inline(const Node* n) const
+{
+    // std::less gives a total order even on unrelated pointers
+    std::less<const void*> less;
+    return !less(n, &slots_[0]) && less(n, slots_ + N);
+}
+
+template <typename T, unsigned N>
+template <typename U>
+typename Small_forward_list<T, N>::Node* Small_forward_list<T, N>::make_node(U&& data, Node* next)
+{
+    Slot* slot = nullptr;
+    if (this->free_ != nullptr)
+    {
+        slot = this->free_;
+        this->free_ = slot->next_free;
+    }
+    else if (this->fresh_ < N)
+    {
+        slot = &this->slots_[this->fresh_++];
+    }
+    else
+    {
+        return new Node(std::forward<U>(data), next);
+    }
+    return new (&slot->node) Node(std::forward<U>(data), next);
+}
+
+template <typename T, unsigned N>
+void Small_forward_list<T, N>::destroy_node(Node* n)
+{
+    if (!is_inline(n))
+    {
+        delete n;
+        return;
+    }
+    // the node is the only member of its slot, so they share an address
+    Slot* slot = reinterpret_cast<Slot*>(n);
+    n->~Node();
+    slot->next_free = this->free_;
+    this->free_ = slot;
+}
+
+template <typename T, unsigned N>
+void Small_forward_list<T, N>::clear()
+{
+    while (this->head_ != nullptr)
+    {
+        Node* tmp = this->head_;
+        this->head_ = tmp->next;
+        destroy_node(tmp);
+    }
+    this->size_ = 0;
+    this->fresh_ = 0;
+    this->free_ = nullptr;
+}
+
+template <typename T, unsigned N>
+void Small_forward_list<T, N>::copy_chain(const Node* chain)
+{
+    Node** tail = &this->head_;
+    while (*tail != nullptr)
+    {
+        tail = &(*tail)->next;
+    }
+    for (; chain != nullptr; chain = chain->next)
+    {
+        *tail = make_node(chain->data, nullptr);
+        tail = &(*tail)->next;
+        this->size_++;
+    }
+}
+
+template <typename T, unsigned N>
+typename Small_forward_list<T, N>::Node* Small_forward_list<T, N>::adopt(Small_forward_list& from, Node* chain)
+{
+    Node** link = &chain;
+    while (*link != nullptr)
+    {
+        Node* n = *link;
+        if (from.is_inline(n))
+        {
+            Node* moved = make_node(std::move(n->data), n->next);
+            from.destroy_node(n);
+            *link = moved;
+            n = moved;
+        }
+        link = &n->next;
+    }
+    return chain;
+}
+
+template <typename T, unsigned N>
+typename Small_forward_list<T, N>::Node* Small_forward_list<T, N>::merge_chains(Node* a, Node* b)
+{
+    Node* head = nullptr;
+    Node** tail = &head;
+    while (a != nullptr && b != nullptr)
+    {
+        if (b->data < a->data)
+        {
+            *tail = b;
+            b = b->next;
+        }
+        else
+        {
+            *tail = a;
+            a = a->next;
+        }
+        tail = &(*tail)->next;
+    }
+    *tail = (a != nullptr) ? a : b;
+    return head;
+}
+
+#endif
@@ -7,14 +7,62 @@
 #include <cassert>
 #include <string>
 #include <forward_list>
+#include <iterator>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <limits>
 #include "forward_list.hpp"
+#include "external_sort.hpp"
+#include "small_forward_list.hpp"
+#include "../common/workload.hpp"
+#include "../common/complexity.hpp"
+
+// A record sorted by its key alone, through a Radix_key specialisation
+struct Keyed_record
+{
+    unsigned key;
+    int position;
+    bool operator<(const Keyed_record& other) const { return key < other.key; }
+};
+
+template <>
+struct Radix_key<Keyed_record>
+{
+    static constexpr bool enabled = true;
+    typedef unsigned type;
+    static type key(const Keyed_record& r) { return r.key; }
+};
+
+// A key counting every call of its operator<, to check the
+// comparison counters of the sorts against
+struct Counted_key
+{
+    int value;
+    static inline std::uint64_t comparisons = 0;
+    bool operator<(const Counted_key& other) const
+    {
+        ++comparisons;
+        return value < other.value;
+    }
+};
 
 class Tests
 {
+private:
+    // the seed of every random choice, printed by the driver
+    // so that a failing run can be repeated
+    unsigned seed_;
+
 public:
-    Tests()
+    explicit Tests(unsigned seed = time(NULL)) : seed_(seed)
+    {
+        srand(seed);
+    }
+
+    unsigned seed() const
     {
-        srand(time(NULL));
+        return seed_;
     }
 
     void test_size_initialization(void)
@@ -286,7 +334,877 @@ public:
             my_list.pop_front();
         }   
         std::cout << "passed test_split_and_merge\n";
-    }   
+    }
+
+    void test_save_load(void)
+    {
+        const unsigned s = rand() % 2000;
+        std::vector<int> v1(s);
+        std::generate(v1.begin(),v1.end(),[](){return rand() % 1000;});
+        Forward_list<int> my_list;
+        for(auto it = v1.rbegin(); it != v1.rend(); ++it)
+        {
+            my_list.push_front(*it);
+        }
+        std::stringstream buffer;
+        assert(my_list.save(buffer));
+        Forward_list<int> loaded {3, 2, 1};
+        assert(loaded.load(buffer));
+        assert(loaded.size() == s);
+        for(int x : v1)
+        {
+            assert(loaded.front() == x);
+            loaded.pop_front();
+        }
+
+        Forward_list<std::string> str_list {"kangaroo", "", "bilby"};
+        std::stringstream str_buffer;
+        assert(str_list.save(str_buffer));
+        // a list of another type must refuse the data and stay unchanged
+        std::stringstream copy_buffer(str_buffer.str());
+        assert(!my_list.load(copy_buffer));
+        assert(my_list.size() == s);
+        Forward_list<std::string> loaded_str;
+        assert(loaded_str.load(str_buffer));
+        assert(loaded_str.size() == 3);
+        assert(loaded_str.front() == "kangaroo");
+        loaded_str.pop_front();
+        assert(loaded_str.front() == "");
+        loaded_str.pop_front();
+        assert(loaded_str.front() == "bilby");
+
+        // a corrupt string length, here that of "kangaroo" after the
+        // 16 byte header, must fail the load rather than allocate it
+        std::string corrupt = str_buffer.str();
+        const std::uint64_t huge = std::uint64_t(1) << 40;
+        std::memcpy(&corrupt[16], &huge, sizeof(huge));
+        std::stringstream corrupt_buffer(corrupt);
+        assert(!loaded_str.load(corrupt_buffer));
+        assert(loaded_str.size() == 1);
+        std::cout << "passed test_save_load\n";
+    }
+
+    // write in each format, with strings that need quoting, and a
+    // list long enough to pass through the buffer several times
+    void test_write(void)
+    {
+        Forward_list<int> my_list {3, -1, 20};
+        Text_options options;
+        std::ostringstream plain;
+        assert(my_list.write(plain));
+        assert(plain.str() == "3 -1 20\n");
+        options.separator = ", ";
+        std::ostringstream separated;
+        assert(my_list.write(separated, options));
+        assert(separated.str() == "3, -1, 20\n");
+        options.format = Text_format::lines;
+        std::ostringstream lines;
+        assert(my_list.write(lines, options));
+        assert(lines.str() == "3\n-1\n20\n");
+        options.format = Text_format::csv;
+        std::ostringstream csv;
+        assert(my_list.write(csv, options));
+        assert(csv.str() == "key\n3\n-1\n20\n");
+        options.format = Text_format::json;
+        std::ostringstream json;
+        assert(my_list.write(json, options));
+        assert(json.str() == "[3,-1,20]\n");
+        Forward_list<int> empty_list;
+        std::ostringstream empty_json;
+        assert(empty_list.write(empty_json, options));
+        assert(empty_json.str() == "[]\n");
+
+        Forward_list<std::string> str_list {"a,b", "say \"hi\"", "x"};
+        std::ostringstream str_json;
+        assert(str_list.write(str_json, options));
+        assert(str_json.str() == "[\"a,b\",\"say \\\"hi\\\"\",\"x\"]\n");
+        options.format = Text_format::csv;
+        std::ostringstream str_csv;
+        assert(str_list.write(str_csv, options));
+        assert(str_csv.str() == "key\n\"a,b\"\n\"say \"\"hi\"\"\"\nx\n");
+        Forward_list<char> char_list {',', '"', 'x'};
+        std::ostringstream char_csv;
+        assert(char_list.write(char_csv, options));
+        assert(char_csv.str() == "key\n\",\"\n\"\"\"\"\nx\n");
+
+        Forward_list<double> double_list {0.5, 1e300};
+        std::ostringstream doubles;
+        assert(double_list.write(doubles));
+        assert(doubles.str() == "0.5 1e+300\n");
+
+        Forward_list<int> long_list;
+        std::string expected;
+        for(int i = 0; i < 50000; ++i)
+        {
+            long_list.push_front(i);
+        }
+        for(int i = 50000 - 1; i >= 0; --i)
+        {
+            expected += std::to_string(i) + '\n';
+        }
+        options.format = Text_format::lines;
+        std::FILE* file = std::tmpfile();
+        assert(file != nullptr);
+        assert(long_list.write(fileno(file), options));
+        std::rewind(file);
+        std::string written(expected.size() + 1, '\0');
+        assert(std::fread(&written[0], 1, written.size(), file) == expected.size());
+        std::fclose(file);
+        written.resize(expected.size());
+        assert(written == expected);
+        std::cout << "passed test_write\n";
+    }
+
+    // key with its original position, to check that sorting is stable
+    struct Record
+    {
+        int key;
+        int position;
+        bool operator<(const Record& other) const { return key < other.key; }
+    };
+
+    void test_external_sort(void)
+    {
+        const int s = 1 + rand() % 5000;
+        std::vector<Record> v1(s);
+        std::stringstream input;
+        {
+            Binary_writer writer(input);
+            for(int i = 0; i < s; ++i)
+            {
+                v1[i] = Record{rand() % 100, i};
+                writer.write(&v1[i], sizeof(Record));
+            }
+        }
+        std::stable_sort(v1.begin(), v1.end());
+
+        // a tiny budget and fan in force many runs and several merge passes
+        External_sort_options options;
+        options.memory_budget = 64 * sizeof(Forward_list<Record>::Node);
+        options.max_fan_in = 3;
+        std::stringstream output;
+        assert(external_sort<Record>(input, output, options));
+        for(const Record& expected : v1)
+        {
+            Record r;
+            assert(output.read(reinterpret_cast<char*>(&r), sizeof(Record)));
+            assert(r.key == expected.key && r.position == expected.position);
+        }
+        assert(output.peek() == EOF);
+
+        // the same data sorted into a Forward_list
+        output.clear();
+        output.seekg(0);
+        Forward_list<Record> my_list;
+        my_list.push_front(Record{-1, -1});
+        assert(external_sort<Record>(output, my_list, options));
+        assert(my_list.size() == static_cast<unsigned>(s));
+        for(const Record& expected : v1)
+        {
+            assert(my_list.front().position == expected.position);
+            my_list.pop_front();
+        }
+
+        // with no budget at all every record is a run of its own
+        External_sort_options no_budget;
+        no_budget.memory_budget = 0;
+        output.clear();
+        output.seekg(0);
+        assert(external_sort<Record>(output, my_list, no_budget));
+        assert(my_list.size() == static_cast<unsigned>(s));
+        for(const Record& expected : v1)
+        {
+            assert(my_list.front().position == expected.position);
+            my_list.pop_front();
+        }
+
+        // a record cut short is an error
+        std::stringstream truncated(std::string(sizeof(Record) + 1, 'x'));
+        assert(!external_sort<Record>(truncated, my_list, options));
+
+        // so is a spilled run whose file came back short, which must not
+        // look like the run ending early
+        std::vector<std::unique_ptr<External_run<int>>> runs;
+        for(int r = 0; r < 2; ++r)
+        {
+            runs.emplace_back(new External_run<int>());
+            assert(runs.back()->good());
+            Binary_writer writer(runs.back()->fd());
+            for(int i = 0; i < 100; ++i)
+            {
+                assert(Binary_codec<int>::write(writer, 2 * i + r));
+                runs.back()->size++;
+            }
+            assert(writer.flush());
+        }
+        int merged = 0;
+        auto count = [&merged](const int&) { ++merged; return true; };
+        assert(external_merge_runs(runs, 0, 2, count) && merged == 200);
+        assert(ftruncate(runs[1]->fd(), 50 * sizeof(int)) == 0);
+        merged = 0;
+        assert(!external_merge_runs(runs, 0, 2, count));
+        assert(merged < 200);
+        std::cout << "passed test_external_sort\n";
+    }
+
+    void test_merge_all(void)
+    {
+        const int k = rand() % 12;
+        std::vector<Record> all;
+        Forward_list<Record> my_list;
+        std::vector<Forward_list<Record>> lists(k);
+        // list -1 is *this, keys are small so there are many ties
+        for(int list = -1; list < k; ++list)
+        {
+            Forward_list<Record>& target = (list < 0) ? my_list : lists[list];
+            std::vector<Record> v(rand() % 30);
+            for(unsigned i = 0; i < v.size(); ++i)
+            {
+                v[i] = Record{rand() % 10, static_cast<int>(all.size() + i)};
+            }
+            std::stable_sort(v.begin(), v.end());
+            for(auto it = v.rbegin(); it != v.rend(); ++it)
+            {
+                target.push_front(*it);
+            }
+            all.insert(all.end(), v.begin(), v.end());
+        }
+        std::stable_sort(all.begin(), all.end());
+
+        my_list.merge_all(lists);
+        assert(my_list.size() == all.size());
+        for(const Forward_list<Record>& other : lists)
+        {
+            assert(other.empty() && other.size() == 0);
+        }
+        for(const Record& expected : all)
+        {
+            assert(my_list.front().position == expected.position);
+            my_list.pop_front();
+        }
+        assert(my_list.empty());
+        std::cout << "passed test_merge_all\n";
+    }
+
+    // asserts that my_list and real_list hold the same elements
+    // my_list is walked through a copy, as Forward_list has no iterators
+    void check_against(const Forward_list<int>& my_list, const std::forward_list<int>& real_list)
+    {
+        Forward_list<int> copy {my_list};
+        assert(copy.size() == my_list.size());
+        for(int x : real_list)
+        {
+            assert(!copy.empty() && copy.front() == x);
+            copy.pop_front();
+        }
+        assert(copy.empty());
+    }
+
+    // Runs random operations on a Forward_list and a std::forward_list
+    // side by side, with values from each distribution of
+    // common/workload.hpp, and asserts that both always agree
+    void test_differential(std::size_t operations)
+    {
+        const Distribution distributions[] = {Distribution::uniform, Distribution::sorted,
+            Distribution::reversed, Distribution::zipfian, Distribution::duplicate_heavy};
+        std::mt19937_64 mt(seed_);
+        for(Distribution d : distributions)
+        {
+            std::vector<int> values = make_keys(d, operations, mt());
+            const std::size_t check_every = std::max<std::size_t>(operations / 64, 1);
+            Forward_list<int> my_list;
+            std::forward_list<int> real_list;
+            std::size_t real_size = 0;
+            std::uniform_int_distribution<int> op_dist(0, 99);
+            for(std::size_t i = 0; i < operations; ++i)
+            {
+                int op = op_dist(mt);
+                if(op < 60)
+                {
+                    my_list.push_front(values[i]);
+                    real_list.push_front(values[i]);
+                    ++real_size;
+                }
+                else if(op < 90)
+                {
+                    assert(my_list.front() == (real_list.empty() ? 0 : real_list.front()));
+                    my_list.pop_front();
+                    if(!real_list.empty())
+                    {
+                        real_list.pop_front();
+                        --real_size;
+                    }
+                }
+                else if(op < 93)
+                {
+                    my_list.reverse();
+                    real_list.reverse();
+                }
+                else if(op < 96)
+                {
+                    // keep the lists short enough for the linear operations
+                    Forward_list<int> second = my_list.split();
+                    auto it = real_list.before_begin();
+                    std::advance(it, (real_size + 1) / 2);
+                    std::forward_list<int> real_second;
+                    real_second.splice_after(real_second.before_begin(), real_list, it, real_list.end());
+                    real_size = (real_size + 1) / 2;
+                    if(op == 93)
+                    {
+                        // put the halves back together sorted
+                        my_list.sort();
+                        second.sort();
+                        my_list.merge(second);
+                        real_list.sort();
+                        real_second.sort();
+                        real_list.merge(real_second);
+                        real_size = std::distance(real_list.begin(), real_list.end());
+                    }
+                }
+                else if(op < 98)
+                {
+                    my_list.sort();
+                    real_list.sort();
+                }
+                else
+                {
+                    Forward_list<int> copy {my_list};
+                    check_against(copy, real_list);
+                }
+                assert(my_list.size() == real_size);
+                if(i % check_every == 0)
+                {
+                    check_against(my_list, real_list);
+                }
+            }
+            check_against(my_list, real_list);
+        }
+        std::cout << "passed test_differential with " << operations << " operations\n";
+    }
+
+    // Fits how the time of building, sorting and copying a list of n
+    // random values grows with n, for Forward_list and for
+    // std::forward_list doing the same work.  Both are O(n log n) and
+    // suffer the same cache effects as n grows, so their exponents
+    // should be close.  An exponent about 1 higher than the reference
+    // would mean merge or split has stopped being linear.
+    void test_complexity(void)
+    {
+        const std::vector<double> sizes {1 << 15, 1 << 16, 1 << 17, 1 << 18};
+        const std::vector<int> values = make_keys(Distribution::uniform, 1 << 18, seed_);
+        double exponent = measure_growth(sizes, [&values](std::size_t n)
+        {
+            Forward_list<int> my_list;
+            for(std::size_t i = 0; i < n; ++i)
+            {
+                my_list.push_front(values[i]);
+            }
+            my_list.sort();
+            Forward_list<int> copy {my_list};
+            assert(copy.size() == n);
+        });
+        double reference = measure_growth(sizes, [&values](std::size_t n)
+        {
+            std::forward_list<int> real_list;
+            for(std::size_t i = 0; i < n; ++i)
+            {
+                real_list.push_front(values[i]);
+            }
+            real_list.sort();
+            std::forward_list<int> copy {real_list};
+            assert(!copy.empty());
+        });
+        std::cout << "Forward_list growth exponent " << exponent
+                  << ", std::forward_list growth exponent " << reference << '\n';
+        assert(exponent - reference < 0.5);
+        std::cout << "passed test_complexity\n";
+    }
+
+    // Checks the counters of the Count_stats policy and that the
+    // default No_stats policy adds nothing to the size of a list
+    void test_stats(void)
+    {
+        struct Plain_list
+        {
+            unsigned size;
+            Forward_list<int>::Node* head;
+        };
+        assert(sizeof(Forward_list<int>) == sizeof(Plain_list));
+        assert(Forward_list<int>().stats().allocations == 0);
+
+        const unsigned n = 1 + (rand() % 200);
+        Forward_list<int, Count_stats> my_list;
+        for(unsigned i = 0; i < n; ++i)
+        {
+            my_list.push_front(rand() % 1000);
+        }
+        assert(my_list.stats().allocations == n);
+        // lists of int are radix sorted, which compares nothing
+        my_list.sort();
+        Container_stats sorted = my_list.stats();
+        if(n > 1)
+        {
+            assert(sorted.nodes_relinked > 0);
+        }
+        assert(sorted.comparisons == 0);
+        Forward_list<int, Count_stats> other {rand() % 1000};
+        my_list.merge(other);
+        assert(my_list.stats().comparisons > 0);
+        assert(my_list.stats().comparisons <= n);
+
+        // the comparison sorts count every comparison, by merge_sort
+        // through its recursion and by gathering
+        for(std::size_t threshold : {std::size_t(64), std::numeric_limits<std::size_t>::max()})
+        {
+            Forward_list<Counted_key, Count_stats> keys;
+            for(unsigned i = 0; i < n; ++i)
+            {
+                keys.push_front(Counted_key {rand() % 1000});
+            }
+            Sort_options options;
+            options.gather_threshold = threshold;
+            Counted_key::comparisons = 0;
+            keys.sort(options);
+            assert(keys.stats().comparisons == Counted_key::comparisons);
+        }
+
+        // gathering takes one relink per node, and its memory estimate
+        // includes the padding of the entries: a budget that only holds
+        // the unpadded key and pointer falls back to merge_sort
+        const std::size_t gathered = 1000;
+        struct Padded
+        {
+            Counted_key key;
+            void* node;
+        };
+        const std::size_t unpadded = sizeof(Counted_key) + sizeof(void*);
+        for(std::size_t entry : {unpadded, sizeof(Padded)})
+        {
+            Forward_list<Counted_key, Count_stats> keys;
+            for(std::size_t i = 0; i < gathered; ++i)
+            {
+                keys.push_front(Counted_key {rand() % 1000});
+            }
+            Sort_options options;
+            options.memory_budget = 2 * entry * gathered;
+            keys.sort(options);
+            assert((keys.stats().nodes_relinked == gathered) == (entry == sizeof(Padded)));
+        }
+
+        my_list.reset_stats();
+        assert(my_list.stats().comparisons == 0);
+        while(!my_list.empty())
+        {
+            my_list.pop_front();
+        }
+        // the n pushed values and the one merged in
+        assert(my_list.stats().frees == n + 1);
+        assert(my_list.stats().allocations == 0);
+        std::cout << "passed test_stats\n";
+    }
+
+    // The parts of memory_usage add up, and long strings report
+    // their heap blocks while short ones stay inside the node
+    void test_memory_usage(void)
+    {
+        Forward_list<int> my_list;
+        Memory_usage empty = my_list.memory_usage();
+        assert(empty.nodes == 0 && empty.total() == sizeof(my_list));
+        assert(empty.overhead_per_node() == 0.0);
+        for(int i = 0; i < 10; ++i)
+        {
+            my_list.push_front(i);
+        }
+        Memory_usage m = my_list.memory_usage();
+        assert(m.nodes == 10);
+        assert(m.node.node_bytes == sizeof(Forward_list<int>::Node));
+        assert(m.node.key_bytes + m.node.link_bytes + m.node.other_bytes + m.node.padding_bytes
+               == m.node.node_bytes);
+        assert(m.node.allocation_bytes >= m.node.node_bytes);
+        assert(m.payload_bytes == 10 * sizeof(int));
+        assert(m.heap_payload_bytes == 0);
+        assert(m.total() == sizeof(my_list) + 10 * m.node.allocation_bytes);
+        assert(m.within(m.total()) && !m.within(m.total() - 1));
+
+        Forward_list<std::string> str_list {"short", std::string(100, 'x'), std::string(1000, 'y')};
+        Memory_usage s = str_list.memory_usage();
+        assert(s.heap_payload_bytes >= 1100 + 2);
+        assert(s.heap_payload_bytes < 1200 + 2);
+        assert(s.total() >= sizeof(str_list) + 3 * s.node.allocation_bytes + s.heap_payload_bytes);
+        assert(s.overhead_per_node() > m.node.node_bytes - sizeof(int));
+        std::cout << "passed test_memory_usage\n";
+    }
+
+    // the contents of a Small_forward_list, front to back
+    template <typename T, unsigned N>
+    std::vector<T> small_list_vec(const Small_forward_list<T, N>& my_list)
+    {
+        Small_forward_list<T, N> copy {my_list};
+        std::vector<T> vec;
+        for(; !copy.empty(); copy.pop_front())
+        {
+            vec.push_back(copy.front());
+        }
+        return vec;
+    }
+
+    // Random operations on Small_forward_lists holding strings, which
+    // the sanitizers watch for use after free and leaks, compared with
+    // std::forward_list.  Lists grow past their four inline nodes and
+    // shrink again, and nodes pass between lists by move, merge and split.
+    void test_small_list(void)
+    {
+        typedef Small_forward_list<std::string, 4> Small_list;
+        Small_list lists[2];
+        std::forward_list<std::string> real_lists[2];
+        for(int op = 0; op < 2000; ++op)
+        {
+            const int a = rand() % 2;
+            Small_list& my_list = lists[a];
+            std::forward_list<std::string>& real_list = real_lists[a];
+            switch(rand() % 8)
+            {
+                case 0:
+                case 1:
+                case 2:
+                {
+                    std::string value = "value number " + std::to_string(rand() % 50);
+                    my_list.push_front(value);
+                    real_list.push_front(value);
+                    break;
+                }
+                case 3:
+                    my_list.pop_front();
+                    if(!real_list.empty())
+                    {
+                        real_list.pop_front();
+                    }
+                    break;
+                case 4:
+                    my_list.sort();
+                    real_list.sort();
+                    break;
+                case 5:
+                    lists[0].sort();
+                    lists[1].sort();
+                    real_lists[0].sort();
+                    real_lists[1].sort();
+                    my_list.merge(lists[1 - a]);
+                    real_list.merge(real_lists[1 - a]);
+                    break;
+                case 6:
+                {
+                    Small_list second = my_list.split();
+                    std::size_t n = std::distance(real_list.begin(), real_list.end());
+                    auto last = real_list.before_begin();
+                    std::advance(last, n < 2 ? n : (n + 1) / 2);
+                    std::forward_list<std::string> real_second;
+                    real_second.splice_after(real_second.before_begin(), real_list, last, real_list.end());
+                    lists[1 - a] = std::move(second);
+                    real_lists[1 - a].swap(real_second);
+                    break;
+                }
+                default:
+                {
+                    Small_list moved {std::move(my_list)};
+                    assert(my_list.empty());
+                    lists[1 - a] = moved;
+                    my_list = std::move(moved);
+                    real_lists[1 - a] = real_list;
+                    break;
+                }
+            }
+            for(int i = 0; i < 2; ++i)
+            {
+                std::vector<std::string> expected(real_lists[i].begin(), real_lists[i].end());
+                assert(small_list_vec(lists[i]) == expected);
+                assert(lists[i].size() == expected.size());
+                assert(lists[i].front() == (expected.empty() ? std::string() : expected.front()));
+            }
+        }
+
+        // front of an empty list gives T() like Forward_list
+        Small_forward_list<int, 2> empty_list;
+        assert(empty_list.front() == 0);
+        empty_list.push_front(5);
+        empty_list.pop_front();
+        assert(empty_list.empty() && empty_list.front() == 0);
+
+        // sort must be stable
+        Small_forward_list<Record> records;
+        std::vector<Record> expected;
+        for(int i = 0; i < 100; ++i)
+        {
+            Record r {rand() % 10, i};
+            records.push_front(r);
+            expected.insert(expected.begin(), r);
+        }
+        records.sort();
+        std::stable_sort(expected.begin(), expected.end());
+        for(const Record& r : expected)
+        {
+            assert(records.front().key == r.key && records.front().position == r.position);
+            records.pop_front();
+        }
+        std::cout << "passed test_small_list\n";
+    }
+
+    // sorts values with sort and with std::stable_sort and compares
+    template <typename T>
+    void check_radix_sort(const std::vector<T>& values)
+    {
+        Forward_list<T> my_list;
+        for(auto it = values.rbegin(); it != values.rend(); ++it)
+        {
+            my_list.push_front(*it);
+        }
+        my_list.sort();
+        std::vector<T> expected = values;
+        std::stable_sort(expected.begin(), expected.end());
+        for(const T& x : expected)
+        {
+            assert(!my_list.empty() && !(my_list.front() < x) && !(x < my_list.front()));
+            my_list.pop_front();
+        }
+        assert(my_list.empty());
+    }
+
+    // The radix path of sort on signed, unsigned, narrow and wide
+    // integers including the extremes, and its stability on records,
+    // and bool, which is integral but sorted by comparison
+    void test_radix_sort(void)
+    {
+        const int s = 1 + rand() % 3000;
+        std::vector<int> ints(s);
+        std::vector<long long> longs(s);
+        std::vector<unsigned char> bytes(s);
+        std::vector<Keyed_record> records(s);
+        for(int i = 0; i < s; ++i)
+        {
+            ints[i] = rand() - RAND_MAX / 2;
+            longs[i] = (static_cast<long long>(rand()) << 33) * ((rand() % 2) ? 1 : -1) + rand();
+            bytes[i] = static_cast<unsigned char>(rand());
+            records[i] = Keyed_record {static_cast<unsigned>(rand() % 50), i};
+        }
+        ints.push_back(std::numeric_limits<int>::min());
+        ints.push_back(std::numeric_limits<int>::max());
+        longs.push_back(std::numeric_limits<long long>::min());
+        longs.push_back(std::numeric_limits<long long>::max());
+        check_radix_sort(ints);
+        check_radix_sort(longs);
+        check_radix_sort(bytes);
+        check_radix_sort(std::vector<int>(100, 7));
+
+        // bool has no Radix_key and sorts by comparison, false first
+        Forward_list<bool> flags;
+        int set = 0;
+        for(int i = 0; i < s; ++i)
+        {
+            bool flag = rand() % 2 == 1;
+            set += flag;
+            flags.push_front(flag);
+        }
+        flags.sort();
+        for(int i = 0; i < s; ++i)
+        {
+            assert(flags.front() == (i >= s - set));
+            flags.pop_front();
+        }
+        assert(flags.empty());
+
+        Forward_list<Keyed_record> my_list;
+        for(auto it = records.rbegin(); it != records.rend(); ++it)
+        {
+            my_list.push_front(*it);
+        }
+        my_list.sort();
+        std::stable_sort(records.begin(), records.end());
+        for(const Keyed_record& r : records)
+        {
+            assert(my_list.front().key == r.key && my_list.front().position == r.position);
+            my_list.pop_front();
+        }
+        std::cout << "passed test_radix_sort\n";
+    }
+
+    // the contents of a Forward_list, front to back
+    std::vector<int> list_vec(const Forward_list<int>& my_list)
+    {
+        Forward_list<int> copy {my_list};
+        std::vector<int> vec;
+        for(; !copy.empty(); copy.pop_front())
+        {
+            vec.push_back(copy.front());
+        }
+        return vec;
+    }
+
+    // unique and the four set operations on sorted lists with
+    // duplicates, against the std algorithms on vectors
+    void test_set_algebra(void)
+    {
+        for(int test_counter = 0; test_counter < 20; ++test_counter)
+        {
+            std::vector<int> v1(rand() % 30);
+            std::vector<int> v2(rand() % 30);
+            std::generate(v1.begin(), v1.end(), [](){return rand() % 20;});
+            std::generate(v2.begin(), v2.end(), [](){return rand() % 20;});
+            std::sort(v1.begin(), v1.end());
+            std::sort(v2.begin(), v2.end());
+
+            for(int op = 0; op < 5; ++op)
+            {
+                Forward_list<int> my_list1;
+                Forward_list<int> my_list2;
+                for(auto it = v1.rbegin(); it != v1.rend(); ++it)
+                {
+                    my_list1.push_front(*it);
+                }
+                for(auto it = v2.rbegin(); it != v2.rend(); ++it)
+                {
+                    my_list2.push_front(*it);
+                }
+                std::vector<int> expected;
+                auto out = std::back_inserter(expected);
+                switch(op)
+                {
+                    case 0:
+                        my_list1.unique();
+                        std::unique_copy(v1.begin(), v1.end(), out);
+                        break;
+                    case 1:
+                        my_list1.set_union(my_list2);
+                        std::set_union(v1.begin(), v1.end(), v2.begin(), v2.end(), out);
+                        break;
+                    case 2:
+                        my_list1.set_intersection(my_list2);
+                        std::set_intersection(v1.begin(), v1.end(), v2.begin(), v2.end(), out);
+                        break;
+                    case 3:
+                        my_list1.set_difference(my_list2);
+                        std::set_difference(v1.begin(), v1.end(), v2.begin(), v2.end(), out);
+                        break;
+                    default:
+                        my_list1.set_symmetric_difference(my_list2);
+                        std::set_symmetric_difference(v1.begin(), v1.end(), v2.begin(), v2.end(), out);
+                        break;
+                }
+                assert(list_vec(my_list1) == expected);
+                assert(my_list1.size() == expected.size());
+                assert(op == 0 || (my_list2.empty() && my_list2.size() == 0));
+            }
+        }
+        std::cout << "passed test_set_algebra\n";
+    }
+
+#ifdef DSA_HAS_GENERATOR
+    // items produces the list front to back, and merging the items of
+    // sorted lists lazily matches merging them eagerly
+    void test_items(void)
+    {
+        Forward_list<int> empty_list;
+        Generator<int> nothing = empty_list.items();
+        assert(nothing.begin() == std::default_sentinel);
+
+        std::vector<int> v1(rand() % 50 + 10);
+        std::vector<int> v2(rand() % 50);
+        std::generate(v1.begin(), v1.end(), [](){return rand() % 100;});
+        std::generate(v2.begin(), v2.end(), [](){return rand() % 100;});
+        std::sort(v1.begin(), v1.end());
+        std::sort(v2.begin(), v2.end());
+        Forward_list<int> my_list1;
+        Forward_list<int> my_list2;
+        for (auto it = v1.rbegin(); it != v1.rend(); ++it)
+        {
+            my_list1.push_front(*it);
+        }
+        for (auto it = v2.rbegin(); it != v2.rend(); ++it)
+        {
+            my_list2.push_front(*it);
+        }
+
+        std::vector<int> items;
+        for (int x : my_list1.items())
+        {
+            items.push_back(x);
+        }
+        assert(items == v1);
+
+        std::vector<Generator<int>> sources;
+        sources.push_back(my_list1.items());
+        sources.push_back(my_list2.items());
+        std::vector<int> merged_items;
+        for (int x : taken(merged(std::move(sources)), 20))
+        {
+            merged_items.push_back(x);
+        }
+        std::vector<int> expected;
+        std::merge(v1.begin(), v1.end(), v2.begin(), v2.end(), std::back_inserter(expected));
+        expected.resize(std::min<std::size_t>(expected.size(), 20));
+        assert(merged_items == expected);
+        // the lists themselves are untouched
+        assert(list_vec(my_list1) == v1);
+        assert(list_vec(my_list2) == v2);
+        std::cout << "passed test_items\n";
+    }
+#endif
+
+    // Every strategy sort can pick for types without a Radix_key:
+    // merge sort, gathering pointers (strings), gathering keys
+    // (Records), on one thread and on several, all of them stable
+    void test_gather_sort(void)
+    {
+        Sort_options merge_only;
+        merge_only.memory_budget = 0;
+        Sort_options parallel;
+        parallel.threads = 4;
+        const Sort_options strategies[] = {merge_only, Sort_options(), parallel};
+
+        const int s = 70000;
+        std::vector<Record> records(s);
+        std::vector<std::string> strings(s / 10);
+        for(int i = 0; i < s; ++i)
+        {
+            records[i] = Record {rand() % 1000, i};
+        }
+        for(std::string& str : strings)
+        {
+            str = "string " + std::to_string(rand() % 5000);
+        }
+        std::vector<Record> sorted_records = records;
+        std::stable_sort(sorted_records.begin(), sorted_records.end());
+        std::vector<std::string> sorted_strings = strings;
+        std::sort(sorted_strings.begin(), sorted_strings.end());
+
+        for(const Sort_options& options : strategies)
+        {
+            Forward_list<Record> record_list;
+            for(auto it = records.rbegin(); it != records.rend(); ++it)
+            {
+                record_list.push_front(*it);
+            }
+            record_list.sort(options);
+            for(const Record& r : sorted_records)
+            {
+                assert(record_list.front().key == r.key && record_list.front().position == r.position);
+                record_list.pop_front();
+            }
+
+            Forward_list<std::string> string_list;
+            for(const std::string& str : strings)
+            {
+                string_list.push_front(str);
+            }
+            string_list.sort(options);
+            for(const std::string& str : sorted_strings)
+            {
+                assert(string_list.front() == str);
+                string_list.pop_front();
+            }
+            assert(string_list.empty());
+        }
+        std::cout << "passed test_gather_sort\n";
+    }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,163 @@
+#ifndef BLOOM_FILTER_HPP
+#define BLOOM_FILTER_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// A blocked Bloom filter over 64-bit key hashes.
+// The bits are split into blocks of one 64 byte cache line.  Part of
+// the hash picks a block and all k bits of a key are set inside that
+// block, so a query touches a single cache line however large k is.
+// This costs a slightly higher false positive rate than a classic Bloom
+// filter with the same number of bits, which is made up for by giving
+// each key about a fifth more bits.
+// Keys cannot be removed, the owner rebuilds the filter instead.
+class Blocked_bloom_filter
+{
+public:
+    // A filter sized for capacity keys with a false positive rate of
+    // about false_positive_rate while it holds no more than that
+    Blocked_bloom_filter(std::size_t capacity, double false_positive_rate)
+        : capacity_(std::max<std::size_t>(capacity, 1))
+    {
+        double rate = std::min(std::max(false_positive_rate, 1e-6), 0.5);
+        // the optimum for a classic filter is -log2(p) / ln 2 bits
+        // per key, plus the allowance for blocking
+        double bits_per_key = 1.2 * -std::log2(rate) / std::log(2.0);
+        hashes_ = std::min(16, std::max(1, static_cast<int>(bits_per_key * std::log(2.0) + 0.5)));
+        std::size_t bits = static_cast<std::size_t>(bits_per_key * capacity_);
+        blocks_.resize(std::max<std::size_t>(1, (bits + block_bits - 1) / block_bits));
+    }
+
+    void insert(std::uint64_t hash)
+    {
+        Block& block = blocks_[block_of(hash)];
+        std::uint64_t bits = mix(hash);
+        for(int i = 0; i < hashes_; ++i)
+        {
+            unsigned bit = next_bit(bits, i);
+            block.words[bit / 64] |= std::uint64_t(1) << (bit % 64);
+        }
+    }
+
+    // false means the key was certainly never inserted
+    bool may_contain(std::uint64_t hash) const
+    {
+        const Block& block = blocks_[block_of(hash)];
+        std::uint64_t bits = mix(hash);
+        for(int i = 0; i < hashes_; ++i)
+        {
+            unsigned bit = next_bit(bits, i);
+            if((block.words[bit / 64] & (std::uint64_t(1) << (bit % 64))) == 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void clear()
+    {
+        std::fill(blocks_.begin(), blocks_.end(), Block());
+    }
+
+    std::size_t capacity() const { return capacity_; }
+    std::size_t bytes() const { return blocks_.size() * sizeof(Block); }
+
+private:
+    static constexpr unsigned block_bits = 512;
+
+    struct alignas(64) Block
+    {
+        std::uint64_t words[8] = {};
+    };
+
+    // the high half of the hash picks the block, scaled onto the
+    // number of blocks with a multiply instead of a division
+    std::size_t block_of(std::uint64_t hash) const
+    {
+        return static_cast<std::size_t>(((hash >> 32) * blocks_.size()) >> 32);
+    }
+
+    // a second, independent looking hash for the bits in the block
+    static std::uint64_t mix(std::uint64_t hash)
+    {
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+    // nine bits of the mixed hash give one bit position in the block,
+    // and the hash is stirred again once its seven slices are used
+    static unsigned next_bit(std::uint64_t& bits, int i)
+    {
+        if(i > 0 && i % 7 == 0)
+        {
+            bits = mix(bits + 0x9e3779b97f4a7c15ULL);
+        }
+        return static_cast<unsigned>(bits >> (9 * (i % 7))) % block_bits;
+    }
+
+    std::size_t capacity_;
+    int hashes_ = 1;
+    std::vector<Block> blocks_;
+};
+
+// Whether std::hash can hash a T.  Containers that put the filter in
+// front of their lookups check this, so that key types with operator<
+// but no std::hash still work with the filter off.
+template <typename T, typename = void>
+struct Is_filter_hashable : std::false_type {};
+
+template <typename T>
+struct Is_filter_hashable<T, std::void_t<decltype(std::hash<T>()(std::declval<const T&>()))>>
+    : std::true_type {};
+
+// Hash of a key for the filter.  std::hash of an integer is often the
+// integer itself, so it is passed through a finaliser that spreads
+// every input bit over the whole 64 bits.
+template <typename T>
+std::uint64_t filter_hash(const T& key)
+{
+    std::uint64_t h = std::hash<T>()(key);
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    return h;
+}
+
+// Counters of a filter placed in front of a container's lookups
+struct Filter_stats
+{
+    // lookups that went through the filter
+    std::uint64_t lookups = 0;
+    // lookups answered "not present" by the filter alone
+    std::uint64_t filtered = 0;
+    // lookups the filter let through for keys that were not present
+    std::uint64_t false_positives = 0;
+    // times the filter was rebuilt from the container's keys
+    std::uint64_t rebuilds = 0;
+
+    // share of all lookups that the filter answered on its own
+    double hit_rate() const
+    {
+        return lookups == 0 ? 0.0 : static_cast<double>(filtered) / lookups;
+    }
+
+    // share of the lookups for absent keys that still searched the tree
+    double false_positive_rate() const
+    {
+        std::uint64_t misses = filtered + false_positives;
+        return misses == 0 ? 0.0 : static_cast<double>(false_positives) / misses;
+    }
+};
+
+#endif
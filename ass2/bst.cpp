@@ -2,12 +2,29 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <cstdlib>
 #include "bst.hpp"
 #include "unit_tests.hpp"
 
-int main()
+// Usage
+//   bst_tests                               the unit tests
+//   bst_tests --stress [operations] [seed]  large scale differential and
+//                                           complexity tests, best built
+//                                           with optimisation
+int main(int argc, char** argv)
 {
+    if(argc > 1 && std::string(argv[1]) == "--stress")
+    {
+        std::size_t operations = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 1000000;
+        Tester stress_test = (argc > 3) ? Tester(std::strtoull(argv[3], nullptr, 10)) : Tester();
+        std::cout << "seed " << stress_test.seed() << std::endl;
+        stress_test.test_differential(operations);
+        stress_test.test_complexity();
+        return 0;
+    }
+
     Tester my_test;
+    std::cout << "seed " << my_test.seed() << std::endl;
     for(int i=0; i < 5;++i)
     {
         my_test.test_insert_string();
@@ -25,7 +42,33 @@ int main()
         my_test.test_rotate_right();
         my_test.test_rotate_root();
         my_test.test_rotate_heights();
+        my_test.test_rotate_left();
+        my_test.test_splay();
+        my_test.test_finger();
+        my_test.test_filter();
+        my_test.test_unhashable_key();
+        my_test.test_priority_queue();
+        my_test.test_multiset();
+        my_test.test_hinted_insert();
+        my_test.test_extract_merge();
+        my_test.test_erase_range();
+#ifdef DSA_HAS_GENERATOR
+        my_test.test_generators();
+#endif
+        my_test.test_persistent_snapshot();
+        my_test.test_persistent_erase();
+        my_test.test_rcu();
+        my_test.test_rcu_concurrent();
+        my_test.test_sharded();
+        my_test.test_sharded_concurrent();
+        my_test.test_save_load();
+        my_test.test_save_load_fd();
+        my_test.test_write();
+        my_test.test_stats();
+        my_test.test_memory_usage();
+        my_test.test_static_set();
         std::cout << "passed " << i << " iterations" << std::endl;
     }
+    my_test.test_differential(20000);
     return 0;
 }
\ No newline at end of file
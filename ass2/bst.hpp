@@ -3,9 +3,20 @@
 
 #include <iostream>
 #include <algorithm>
+#include <limits>
+#include <memory>
+#include <utility>
 #include <vector>
-
-template <typename T>
+#include "bloom_filter.hpp"
+#include "../common/binary_io.hpp"
+#include "../common/container_stats.hpp"
+#include "../common/generator.hpp"
+#include "../common/memory_usage.hpp"
+#include "../common/text_output.hpp"
+
+// Stats is the statistics policy, see common/container_stats.hpp
+// The default No_stats compiles every counter away
+template <typename T, typename Stats = No_stats>
 class BST
 {
 public:
@@ -20,6 +31,8 @@ public:
     public:
         T key;
         int height = 0;
+        // the copies of key held, above 1 only in multiset mode
+        unsigned count = 1;
         Node* left = nullptr;
         Node* right = nullptr;
         Node* parent = nullptr;
@@ -35,6 +48,45 @@ public:
         }
     };
 
+    // An owning handle to a node taken out of a tree by extract
+    // Like the node handles of std::set it can only be moved, it can
+    // be inserted into any tree of the same type without allocating,
+    // and it frees its node if that never happens.
+    class Node_handle
+    {
+    public:
+        Node_handle() {}
+        Node_handle(Node_handle&& other) noexcept : node_(std::exchange(other.node_, nullptr)) {}
+
+        Node_handle& operator=(Node_handle&& other) noexcept
+        {
+            if(this != &other)
+            {
+                delete node_;
+                node_ = std::exchange(other.node_, nullptr);
+            }
+            return *this;
+        }
+
+        ~Node_handle() { delete node_; }
+
+        bool empty() const { return node_ == nullptr; }
+        explicit operator bool() const { return node_ != nullptr; }
+
+        // the key, which may be changed before the node is inserted
+        // Only call these on a handle that is not empty.
+        T& key() const { return node_->key; }
+
+        // the copies of the key held, see set_multiset
+        unsigned count() const { return node_->count; }
+
+    private:
+        friend class BST;
+        explicit Node_handle(Node* node) : node_(node) {}
+
+        Node* node_ = nullptr;
+    };
+
 private:
     // The BST has two private variables, a pointer to the root
     // and an unsigned integer to hold its size
@@ -42,6 +94,38 @@ private:
     // data variables by having a trailing underscore in their names.
     Node* root_ = nullptr;
     unsigned int size_ = 0;
+    // the copies beyond the first summed over all nodes, so that
+    // size_ still counts nodes, see set_multiset
+    unsigned int duplicates_ = 0;
+    // whether accesses splay, see set_splay
+    bool splay_ = false;
+    // whether searches start from finger_, see set_finger
+    bool use_finger_ = false;
+    // whether insert counts copies of a key, see set_multiset
+    bool multiset_ = false;
+    // the node last reached by find or successor, or nullptr
+    Node* finger_ = nullptr;
+    // the nodes holding the smallest and largest keys, nullptr if empty
+    Node* min_ = nullptr;
+    Node* max_ = nullptr;
+
+    // the membership filter and its bookkeeping, see set_filter
+    struct Key_filter
+    {
+        Key_filter(std::size_t capacity, double rate)
+            : bloom(capacity, rate), false_positive_rate(rate) {}
+
+        Blocked_bloom_filter bloom;
+        double false_positive_rate;
+        // keys added since the last rebuild, and how many of them
+        // have been erased from the tree since
+        std::size_t added = 0;
+        std::size_t erased = 0;
+        Filter_stats stats;
+    };
+    std::unique_ptr<Key_filter> filter_;
+    // counters of the statistics policy, takes no space for No_stats
+    [[no_unique_address]] Stats stats_;
 
 
 public:
@@ -59,6 +143,50 @@ public:
     //*** For you to implement
     void insert(T k);
 
+    // Hinted insertion
+    // insert(hint, k) inserts k as insert(k) does, but first checks
+    // whether k belongs right next to hint, that is between hint and
+    // its in-order neighbour, and if so links the new node there
+    // without descending from the root.  Otherwise, or if hint is
+    // nullptr, it falls back to insert(k).  hint must be a node of
+    // this tree.  Returns the node holding k, which makes a good hint
+    // for the next key of an increasing or nearly increasing stream.
+    // The heights above the new node are fixed only until one comes
+    // out unchanged, but without rebalancing an increasing stream still
+    // grows a chain of right children whose heights all change.
+    Node* insert(Node* hint, T k);
+
+    // insert(max(), k): constant time linking when k is larger than
+    // every key in the tree
+    Node* insert_back(T k);
+
+    // Node handles
+    // extract takes the node holding k out of the tree and hands it
+    // over, so it can move to another tree without being freed and
+    // allocated again.  The tree is updated as by erase, and every
+    // other node stays where it was in memory.
+    // Returns an empty handle if k is not in the tree.
+    Node_handle extract(T k);
+
+    // takes the node node, which must be in this tree, out of it
+    Node_handle extract(Node* node);
+
+    // links the node of handle into the tree, and empties handle
+    // If its key is already in the tree the handle keeps the node,
+    // except in multiset mode, where the copies it holds are added to
+    // the key's count and the node is freed.  Returns the node holding
+    // the key, or nullptr if handle is empty.
+    Node* insert(Node_handle&& handle);
+
+    // moves every node of other whose key is not in this tree over to
+    // this tree, relinking the nodes rather than copying the keys.
+    // In multiset mode the copies of keys in both trees move as well.
+    // The nodes are taken in pre-order, parents before children, so
+    // both trees grow in the shape other had rather than into the
+    // chain that inserting in sorted order would make.
+    // Returns the number of keys moved, every copy counting.
+    unsigned merge(BST& other);
+
     // successor
     // Return a pointer to the node containing the smallest key larger 
     // than k
@@ -90,15 +218,87 @@ public:
     //*** For you to implement
     void rotate_right(Node* node);
 
+    // The mirror image of rotate_right, called only when node
+    // has a right child, which becomes the parent of *node
+    void rotate_left(Node* node);
+
     //*** End of methods for you to implement
 
+    // Splay mode
+    // When on, every find, successor and insert moves the node it
+    // reached to the root by splaying (zig, zig-zig and zig-zag
+    // rotations), and erase and delete_min splay the parent of the
+    // removed node.  A lookup that misses splays the last node visited.
+    // Hot keys then stay near the root, and any sequence of m operations
+    // takes O((m + n) log n) time even though a single one can be slow.
+    // Heights stay correct in both modes.  Off by default.
+    void set_splay(bool on);
+    bool splay() const;
+
+    // Finger cache
+    // When on, the tree remembers the node reached by the last find or
+    // successor, and the next search starts from there.  It climbs
+    // through parent pointers only until the key is known to lie below
+    // the node reached, then descends as usual.  A lookup for a key d
+    // positions away from the previous one then walks roughly twice the
+    // height of a subtree holding d keys, O(log d) when the tree is
+    // balanced, instead of the whole depth from the root.
+    // erase, delete_min and load forget the finger.  Off by default.
+    void set_finger(bool on);
+    bool finger() const;
+
+    // Membership filter
+    // set_filter(p) puts a blocked Bloom filter (bloom_filter.hpp) with
+    // a false positive rate of about p in front of find, so that most
+    // lookups for absent keys read one cache line of the filter instead
+    // of walking a root to leaf path.  insert adds keys to the filter.
+    // Bloom filters cannot forget keys, so erase and delete_min only
+    // count them, and the filter is rebuilt from the tree in O(n) once
+    // more keys have been erased than remain, or once the keys added
+    // since the last rebuild exceed its capacity of twice the size at
+    // that time.  set_filter(0) removes the filter.  Off by default.
+    // The filter hashes keys with std::hash, so set_filter only
+    // compiles for key types that have one.
+    void set_filter(double false_positive_rate);
+
+    // counters of the filter since set_filter, zero without a filter
+    Filter_stats filter_stats() const;
+
+    // Multiset mode
+    // When on, inserting a key already in the tree adds another copy
+    // of it instead of doing nothing.  The copies take no extra nodes,
+    // each node counts the copies of its key.  delete_min, pop_min and
+    // pop_min_n take out one copy at a time, erase removes every copy.
+    // find, successor, the traversals and write still see each key
+    // once, save keeps the copies.  Turning the mode off keeps the copies already counted
+    // but stops adding new ones.  Off by default.
+    void set_multiset(bool on);
+    bool multiset() const;
+
+    // the number of copies of k in the tree, 0 if it is absent
+    unsigned count(T k);
+
+    // removes one copy of k, and its node with the last one
+    // Returns false if k is not in the tree
+    bool erase_one(T k);
+
+    // removes every copy of k, as erase does
+    // Returns the number of copies removed
+    unsigned erase_all(T k);
+
     // Returns the number of keys in the tree
     // we implement this for you, but it is up to you to correctly
     // update the size_ variable
+    // Every copy counts in multiset mode.
     unsigned size();
 
+    // the number of different keys, which is the number of nodes
+    unsigned distinct_size();
+
     // Prints out the keys in the tree via an in-order traversal
     // we implement this for you
+    // The lines are built in one buffer, see common/text_output.hpp,
+    // and written to std::cout once it fills up and at the end.
     void print();
 
     // Returns a pointer to the node containing the key k
@@ -110,6 +310,28 @@ public:
     // We implement this for you, it is used in our testing.
     std::vector<T> make_vec();
 
+    // As make_vec, but with expand every key appears as many times
+    // as it was counted in multiset mode
+    std::vector<T> make_vec(bool expand);
+
+#ifdef DSA_HAS_GENERATOR
+    // Lazy traversals, see common/generator.hpp (C++20 only)
+    // Each step follows parent pointers from the current node to its
+    // in-order neighbour, so a traversal needs no stack and stopping
+    // after m keys costs O(m + height) instead of O(n) for make_vec.
+    // Splaying, the finger and the filter are left alone.
+    // The tree must not be changed while a traversal is in use.
+
+    // the keys in increasing order
+    Generator<T> in_order();
+
+    // the keys k with lo <= k < hi in increasing order
+    Generator<T> range(T lo, T hi);
+
+    // the keys in decreasing order
+    Generator<T> reverse_order();
+#endif
+
     // The next two functions are to check your height values 
     // Please do not modify
     std::vector<int> your_postorder_heights();
@@ -123,8 +345,78 @@ public:
 
     // Return a pointer to the node containing the minimum key in the tree
     // We implement this for you
+    // The minimum and maximum are cached, so min and max are O(1)
+    // Rotations and splaying leave the cache alone, as every node
+    // keeps its key.
     Node* min();
 
+    // Return a pointer to the node containing the maximum key in the tree
+    Node* max();
+
+    // Priority queue use
+    // pop_min removes the minimum and stores it in out, or returns false
+    // if the tree is empty.  The cached minimum moves on to its in-order
+    // successor, which is O(1) amortised over a run of pops, and the
+    // heights are only fixed until one comes out unchanged.
+    bool pop_min(T& out);
+
+    // removes the k smallest keys, or all of them if there are fewer,
+    // appending them to out in increasing order
+    // Rather than k separate deletions the removed keys are cut off in
+    // one pass down the left side of the tree, O(k + depth) in all.
+    // In multiset mode every copy counts as a key.
+    // Returns the number of keys removed.
+    unsigned pop_min_n(unsigned k, std::vector<T>& out);
+
+    // Range erase
+    // erase_range(a, b) removes the keys k with a <= k < b, like range,
+    // erase_below(k) the keys smaller than k and erase_above(k) those
+    // larger than k.  Rather than one erase per key, the walk down to
+    // each boundary cuts off whole subtrees, which are freed in one pass
+    // without recursion, and the heights are fixed once along each
+    // boundary path, O(depth + m) in all for m keys removed.
+    // Returns the number of keys removed, every copy counting.
+    unsigned erase_range(T a, T b);
+    unsigned erase_below(T k);
+    unsigned erase_above(T k);
+
+    // Binary serialisation, see common/binary_io.hpp
+    // save writes a header holding the type tag and the number of
+    // nodes, followed by the keys in in-order sequence
+    // A tree holding copies of keys is saved under its own magic, with
+    // the number of copies after each key, so load restores them.
+    // Returns false if writing failed
+    bool save(std::ostream& out) const;
+    bool save(int fd) const;
+
+    // load replaces the tree with one written by save
+    // As the keys arrive sorted, the tree is built perfectly balanced
+    // in linear time rather than by inserting key by key.
+    // If the input is malformed or not strictly increasing the tree
+    // is left unchanged and false is returned
+    bool load(std::istream& in);
+    bool load(int fd);
+
+    // Text output, see common/text_output.hpp
+    // write puts the keys in increasing order as text, in the plain,
+    // one per line, CSV or JSON format chosen by options
+    // Returns false if writing failed
+    bool write(std::ostream& out, const Text_options& options = Text_options()) const;
+    bool write(int fd, const Text_options& options = Text_options()) const;
+
+    // Statistics, see common/container_stats.hpp
+    // With the default No_stats policy every counter reads zero
+    // returns the counters of this tree
+    Container_stats stats() const;
+
+    // sets every counter of this tree back to zero
+    void reset_stats();
+
+    // Memory footprint, see common/memory_usage.hpp
+    // The membership filter counts as part of the container.
+    // O(1), or O(n) for key types that own heap memory
+    Memory_usage memory_usage() const;
+
 private: 
     // We found it useful to have a "fix_height" function.
     // This assumes that the subtrees rooted at node's children have 
@@ -133,21 +425,126 @@ private:
     // You can imlement this, or correct the heights another way
     void fix_height(Node* n);
 
+    // As fix_height, but stops at the first node whose height does not
+    // change, as then none above it can change either.  This needs
+    // the heights above n to have been correct before the change.
+    void fix_height_until_stable(Node* n);
+
+    // recomputes the height of n alone from those of its children
+    void update_height(Node* n);
+
+    // Rotations that only relink nodes and recompute the heights of
+    // the two nodes that moved.  The heights of their ancestors are
+    // left to the caller, which saves a walk to the root per rotation
+    // while splaying, as every ancestor is rotated in turn anyway.
+    void link_rotate_right(Node* node);
+    void link_rotate_left(Node* node);
+
+    // moves node to the root by rotations
+    void splay(Node* node);
+
+    // insert descending from the root, returns the node holding k
+    Node* insert_from_root(const T& k);
+
+    // finds k's place in the tree: returns the node holding k, or
+    // nullptr with parent and right set to the free link for it,
+    // parent being nullptr if the tree is empty
+    Node* find_place(const T& k, Node*& parent, bool& right);
+
+    // as find_place, but first tries next to hint, see insert(hint, k)
+    Node* find_place(Node* hint, const T& k, Node*& parent, bool& right);
+
+    // links node, whose links are clear, as the right or left child of
+    // parent, a free link found by find_place, and does the upkeep of
+    // insert.  Returns node.
+    Node* link(Node* parent, bool right, Node* node);
+
+    // link for a new node holding k
+    Node* attach(Node* parent, bool right, const T& k);
+
+    // detaches node from the tree with the upkeep of erase, and returns
+    // it with its links cleared.  If node has two children its in-order
+    // successor is moved into its place, so no other node changes key.
+    Node* unlink(Node* node);
+
+    // the upkeep of insert when node already holds its key
+    void insert_present(Node* node);
+
+    // find without splaying, used by the functions that
+    // splay on their own terms
+    Node* find_node(const T& k);
+
+    // climbs from finger_ to the lowest node whose subtree
+    // must hold k if k is in the tree
+    Node* finger_start(const T& k);
+
+    // filter_hash of k, or 0 for key types without std::hash, which
+    // cannot have a filter, see set_filter
+    static std::uint64_t filter_key(const T& k);
+
+    // filter upkeep after a key was inserted or erased
+    void filter_insert(const T& k);
+    void filter_erase(std::size_t count = 1);
+
+    // refills the filter with the keys of the tree, sized for twice as many
+    void rebuild_filter();
+
     // The rest of these functions are already implemented
 
     // helper function for the destructor
     void delete_subtree(Node* node);
 
+    // frees the subtree rooted at node without recursion, returns the
+    // number of nodes freed and adds the copies they held to copies
+    unsigned free_subtree(Node* node, unsigned& copies);
+
+    // The cuts of the bulk removals
+    // cut_low frees the keys of the subtree hanging from *link for
+    // which low(key) is true, which must be its smallest keys, and
+    // cut_high those for which high(key) is true, its largest keys.
+    // parent is the node owning *link.  Both return the lowest node
+    // kept on the walk, where the heights start to change, leave the
+    // heights, size and extremes to the caller and add what they freed
+    // to nodes and copies.
+    template <typename Pred>
+    Node* cut_low(Node** link, Node* parent, Pred low, unsigned& nodes, unsigned& copies);
+    template <typename Pred>
+    Node* cut_high(Node** link, Node* parent, Pred high, unsigned& nodes, unsigned& copies);
+
+    // the upkeep after nodes nodes holding copies keys were cut off
+    void after_cut(unsigned nodes, unsigned copies);
+
     // returns pointer to minimum node in subtree rooted by node
     // Assumes node is not nullptr
     Node* min(Node* node);
 
-    // helper function for print
-    void print(Node* node);
-
     // helper function for make_vec
     void make_vec(Node* node, std::vector<T>& vec);
 
+    // helper functions for save and load
+    bool save_to(Binary_writer& out) const;
+    bool load_from(Binary_reader& in);
+
+    // helper function for write
+    bool write_to(Text_writer& out) const;
+
+    // builds a balanced subtree out of the next count keys of in
+    // prev is the node holding the previous key read, used to check
+    // the keys are increasing.  With counted every key is followed by
+    // its number of copies, which is added to copies.  ok is cleared
+    // on any error, the nodes built so far are still linked so the
+    // caller can free them.
+    Node* build_balanced(Binary_reader& in, std::uint64_t count, bool counted,
+                         std::uint64_t& copies, Node*& prev, bool& ok);
+
+    // returns the node following node in an in-order traversal,
+    // or nullptr if node holds the maximum
+    static Node* next_in_order(Node* node);
+
+    // returns the node preceding node in an in-order traversal,
+    // or nullptr if node holds the minimum
+    static Node* prev_in_order(Node* node);
+
     void your_postorder_heights(Node* node, std::vector<int>& vec);
 
     int real_postorder_heights(Node* node, std::vector<int>& vec);
@@ -156,34 +553,60 @@ private:
 
 // Default constructor
 // You do not need to change this
-template <typename T>
-BST<T>::BST()
+template <typename T, typename Stats>
+BST<T, Stats>::BST()
 {
 }
 
 // Destructor
 // We implement this for you
-template <typename T>
-BST<T>::~BST()
+template <typename T, typename Stats>
+BST<T, Stats>::~BST()
 {
     delete_subtree(root_);
 }
 
 // helper function for destructor
-template <typename T>
-void BST<T>::delete_subtree(Node* node)
+template <typename T, typename Stats>
+void BST<T, Stats>::delete_subtree(Node* node)
 {
-    if(node==nullptr)
+    unsigned copies = 0;
+    free_subtree(node, copies);
+}
+
+// A node is freed once it has no left child, and until then its left
+// child is rotated above it.  Each rotation moves one node off the
+// left spine for good, so freeing n nodes takes at most 2n steps and
+// no stack, however deep the subtree.  Parent pointers and heights
+// are left stale as every node goes.
+template <typename T, typename Stats>
+unsigned BST<T, Stats>::free_subtree(Node* node, unsigned& copies)
+{
+    unsigned freed = 0;
+    while(node != nullptr)
     {
-        return;
+        if(node->left != nullptr)
+        {
+            Node* left = node->left;
+            node->left = left->right;
+            left->right = node;
+            node = left;
+        }
+        else
+        {
+            Node* right = node->right;
+            copies += node->count;
+            delete node;
+            stats_.free();
+            ++freed;
+            node = right;
+        }
     }
-    delete_subtree(node->left);
-    delete_subtree(node->right);
-    delete node;
+    return freed;
 }
 
-template <typename T>
-void BST<T>::fix_height(Node* n)
+template <typename T, typename Stats>
+void BST<T, Stats>::fix_height(Node* n)
 {
     // This function assumes that the subtrees of n have correct heights already
     Node* current_node = n;
@@ -199,76 +622,312 @@ void BST<T>::fix_height(Node* n)
 
         // This nodes height is the greater of the l&r subtree heights +1
         current_node->height = std::max(l_height, r_height) + 1;
+        stats_.fix_height_step();
         // Continue advancing up the tree and correcting their heights also
         current_node = current_node->parent;
     }
 }
 
+template <typename T, typename Stats>
+void BST<T, Stats>::fix_height_until_stable(Node* n)
+{
+    while (n != nullptr)
+    {
+        int old_height = n->height;
+        update_height(n);
+        if (n->height == old_height)
+            return;
+        n = n->parent;
+    }
+}
+
 
 //*** For you to implement
-template <typename T>
-void BST<T>::insert(T k)
+template <typename T, typename Stats>
+void BST<T, Stats>::insert(T k)
 {
-    // You can mostly follow your solution from Week 9 lab here
-    // Add functionality to set the parent pointer of the new node created
-    // ++size_;
-    // Also remember to correct the heights on the path from the newly
-    // inserted node to the root.
-    // fix_height(start_fix);
-
-    // node will iterate down through the tree starting from the root
-    // Node* node = root_;
-    // prev_node will hold node's parent
-    Node* node = root_;
-    Node* prev_node = node;
-    bool went_right;
-    int node_height = 0;
+    insert_from_root(k);
+}
 
-    if(node == nullptr)
+template <typename T, typename Stats>
+typename BST<T, Stats>::Node* BST<T, Stats>::insert_from_root(const T& k)
+{
+    Node* parent = nullptr;
+    bool right = false;
+    Node* node = find_place(k, parent, right);
+    if(node != nullptr)
     {
-        root_ = new Node(k);
-        ++size_;
-        return;
+        insert_present(node);
+        return node;
     }
+    return attach(parent, right, k);
+}
+
+template <typename T, typename Stats>
+typename BST<T, Stats>::Node* BST<T, Stats>::find_place(const T& k, Node*& parent, bool& right)
+{
+    // You can mostly follow your solution from Week 9 lab here
+    // node will iterate down through the tree starting from the root
+    // parent will hold node's parent
+    Node* node = root_;
+    parent = nullptr;
+    right = false;
     while(node != nullptr)
     {
-        prev_node = node;
-        node_height++;
+        parent = node;
+        stats_.visit();
+        stats_.comparison();
         if(k < node->key)
         {
             node = node->left;
-            went_right = false;
+            right = false;
         }
         else if (k > node->key)
         {
             node = node->right;
-            went_right = true;
+            right = true;
         }
         // item already in set
         else
         {
-            return;
+            return node;
+        }
+    }
+    // new node is either left or right child of parent
+    return nullptr;
+}
+
+// k's place is next to hint if no key lies between the two.  The
+// neighbour on that side is found through the parent pointers, except
+// at the cached extremes where there is none, which makes appending
+// after max() constant time.  If the link below hint on that side is
+// taken, the neighbour is the extreme of that subtree and its link
+// towards hint is free.
+template <typename T, typename Stats>
+typename BST<T, Stats>::Node* BST<T, Stats>::find_place(Node* hint, const T& k,
+                                                        Node*& parent, bool& right)
+{
+    if(hint == nullptr)
+    {
+        return find_place(k, parent, right);
+    }
+    stats_.comparison();
+    if(hint->key < k)
+    {
+        Node* next = (hint == max_) ? nullptr : next_in_order(hint);
+        if(next == nullptr || k < next->key)
+        {
+            right = (hint->right == nullptr);
+            parent = right ? hint : next;
+            return nullptr;
+        }
+    }
+    else if(k < hint->key)
+    {
+        Node* prev = (hint == min_) ? nullptr : prev_in_order(hint);
+        if(prev == nullptr || prev->key < k)
+        {
+            right = (hint->left != nullptr);
+            parent = right ? prev : hint;
+            return nullptr;
         }
     }
-    // new node is either left or right child of prev_node
-    if(went_right)
+    else
+    {
+        return hint;
+    }
+    return find_place(k, parent, right);
+}
+
+template <typename T, typename Stats>
+typename BST<T, Stats>::Node* BST<T, Stats>::attach(Node* parent, bool right, const T& k)
+{
+    stats_.allocation();
+    return link(parent, right, new Node(k));
+}
+
+// The new node is the in-order neighbour of parent, so the cached
+// extremes move only if parent was one of them.
+template <typename T, typename Stats>
+typename BST<T, Stats>::Node* BST<T, Stats>::link(Node* parent, bool right, Node* node)
+{
+    node->parent = parent;
+    if(parent == nullptr)
+    {
+        root_ = node;
+        min_ = node;
+        max_ = node;
+    }
+    else if(right)
     {
-        prev_node->right= new Node(k, prev_node);
-        node = prev_node->right;
+        parent->right = node;
+        if(parent == max_)
+            max_ = node;
     }
     else
     {
-        prev_node->left= new Node(k, prev_node);
-        node = prev_node->left;
+        parent->left = node;
+        if(parent == min_)
+            min_ = node;
     }
-    fix_height(node);
+    // splaying recomputes the height of every node on the path
+    if(splay_)
+        splay(node);
+    else
+        fix_height_until_stable(parent);
     ++size_;
-    
+    duplicates_ += node->count - 1;
+    filter_insert(node->key);
+    return node;
+}
+
+template <typename T, typename Stats>
+void BST<T, Stats>::insert_present(Node* node)
+{
+    if(multiset_)
+    {
+        ++node->count;
+        ++duplicates_;
+    }
+    if(splay_)
+    {
+        splay(node);
+    }
+}
+
+template <typename T, typename Stats>
+typename BST<T, Stats>::Node* BST<T, Stats>::insert(Node* hint, T k)
+{
+    Node* parent = nullptr;
+    bool right = false;
+    Node* node = find_place(hint, k, parent, right);
+    if(node != nullptr)
+    {
+        insert_present(node);
+        return node;
+    }
+    return attach(parent, right, k);
+}
+
+template <typename T, typename Stats>
+typename BST<T, Stats>::Node* BST<T, Stats>::insert_back(T k)
+{
+    return insert(max_, k);
+}
+
+template <typename T, typename Stats>
+typename BST<T, Stats>::Node_handle BST<T, Stats>::extract(T k)
+{
+    Node* node = find_node(k);
+    if(node == nullptr)
+    {
+        return Node_handle();
+    }
+    return Node_handle(unlink(node));
+}
+
+template <typename T, typename Stats>
+typename BST<T, Stats>::Node_handle BST<T, Stats>::extract(Node* node)
+{
+    return Node_handle(unlink(node));
+}
+
+template <typename T, typename Stats>
+typename BST<T, Stats>::Node* BST<T, Stats>::insert(Node_handle&& handle)
+{
+    if(handle.empty())
+    {
+        return nullptr;
+    }
+    Node* parent = nullptr;
+    bool right = false;
+    Node* node = find_place(handle.node_->key, parent, right);
+    if(node == nullptr)
+    {
+        return link(parent, right, std::exchange(handle.node_, nullptr));
+    }
+    if(multiset_)
+    {
+        node->count += handle.node_->count;
+        duplicates_ += handle.node_->count;
+        handle = Node_handle();
+    }
+    if(splay_)
+    {
+        splay(node);
+    }
+    return node;
+}
+
+// other is emptied first and its nodes are walked as a detached tree,
+// each one either linked into this tree or back into other.
+template <typename T, typename Stats>
+unsigned BST<T, Stats>::merge(BST& other)
+{
+    if(&other == this)
+    {
+        return 0;
+    }
+    std::vector<Node*> pending;
+    if(other.root_ != nullptr)
+    {
+        pending.push_back(other.root_);
+    }
+    other.root_ = nullptr;
+    other.size_ = 0;
+    other.duplicates_ = 0;
+    other.min_ = nullptr;
+    other.max_ = nullptr;
+    other.finger_ = nullptr;
+
+    unsigned moved = 0;
+    while(!pending.empty())
+    {
+        Node* node = pending.back();
+        pending.pop_back();
+        // the left child is pushed last so that it comes out first
+        if(node->right != nullptr)
+            pending.push_back(node->right);
+        if(node->left != nullptr)
+            pending.push_back(node->left);
+        node->left = nullptr;
+        node->right = nullptr;
+        node->parent = nullptr;
+        node->height = 0;
+
+        Node* parent = nullptr;
+        bool right = false;
+        Node* present = find_place(node->key, parent, right);
+        if(present == nullptr)
+        {
+            moved += node->count;
+            link(parent, right, node);
+        }
+        else if(multiset_)
+        {
+            moved += node->count;
+            present->count += node->count;
+            duplicates_ += node->count;
+            delete node;
+            other.stats_.free();
+        }
+        else
+        {
+            other.find_place(node->key, parent, right);
+            other.link(parent, right, node);
+        }
+    }
+    // the keys that left other are still in its filter
+    if(other.filter_ != nullptr)
+    {
+        other.rebuild_filter();
+    }
+    return moved;
 }
 
 //*** For you to implement
-template <typename T>
-typename BST<T>::Node* BST<T>::successor(T k)
+template <typename T, typename Stats>
+typename BST<T, Stats>::Node* BST<T, Stats>::successor(T k)
 {
     // Begin by locating the node that holds key k
     Node* current_node = find(k);
@@ -277,9 +936,10 @@ typename BST<T>::Node* BST<T>::successor(T k)
 
     // Case 1: current_node has a right child
     //         locate the minimum node in the right subtree of current_node
+    Node* next = nullptr;
     if (current_node->right != nullptr)
     {
-        return min(current_node->right);
+        next = min(current_node->right);
     }
     else
     // Case 2: current_node has no right child.
@@ -287,25 +947,45 @@ typename BST<T>::Node* BST<T>::successor(T k)
     {
         while(current_node != nullptr)
         {
+            stats_.visit();
+            stats_.comparison();
             if (current_node->key > k)
-                return current_node; // found a key greater than k
+            {
+                next = current_node; // found a key greater than k
+                break;
+            }
             else
                 current_node = current_node->parent; // keep searching
         }
     }
-    // If we get here then we never found a key larger than k
-    return nullptr;
+    // a scan calls successor on the key just returned, so start there
+    if (use_finger_ && next != nullptr)
+        finger_ = next;
+    // nullptr if we never found a key larger than k
+    return next;
 
 }
 
 //*** For you to implement
-template <typename T>
-void BST<T>::delete_min()
+template <typename T, typename Stats>
+void BST<T, Stats>::delete_min()
 {
     // if tree is empty just return.
-    Node* min_node = min();
+    Node* min_node = min_;
+    finger_ = nullptr;
     if (min_node == nullptr)
         return;
+    // a counted key only loses a copy
+    if (min_node->count > 1)
+    {
+        --min_node->count;
+        --duplicates_;
+        return;
+    }
+    // the next minimum is the successor, found before unlinking
+    min_ = next_in_order(min_node);
+    if (max_ == min_node)
+        max_ = nullptr;
     Node* parent = min_node->parent;
     Node* child = min_node->right;
 
@@ -326,32 +1006,58 @@ void BST<T>::delete_min()
         parent->left = child;
         if (child != nullptr)
             child->parent = parent;
-        fix_height(parent);
+        if (splay_)
+        {
+            update_height(parent);
+            splay(parent);
+        }
+        else
+            fix_height_until_stable(parent);
     }
     // Delete min, update size
     delete min_node;
+    stats_.free();
     --size_;
+    filter_erase();
 }
 
 //*** For you to implement
-template <typename T>
-void BST<T>::erase(T k)
+template <typename T, typename Stats>
+void BST<T, Stats>::erase(T k)
 {
     // locate node holding key k
-    Node* n = find(k);
+    // erase splays on its own below, so use the non-splaying find
+    Node* n = find_node(k);
     if (n == nullptr)
         return;
-    
+    // Delete the node, update size and height
+    delete unlink(n);
+    stats_.free();
+}
+
+template <typename T, typename Stats>
+typename BST<T, Stats>::Node* BST<T, Stats>::unlink(Node* n)
+{
+    finger_ = nullptr;
+    // n is really removed, so move the cached extremes off it
+    if (n == min_)
+        min_ = next_in_order(n);
+    if (n == max_)
+        max_ = prev_in_order(n);
+
     Node* r = n->right;
     Node* l = n->left;
     Node* replacement = nullptr; // default case is n has no children
     Node* parent = n->parent;
+    // the lowest node that lost a descendant, where the heights
+    // start to change
+    Node* lowest = parent;
     // Case 1: n has only left child
     if (r == nullptr && l != nullptr)
     {
         replacement = l;
     }
-    // Case 2: n has only left child
+    // Case 2: n has only right child
     else if (r != nullptr && l == nullptr)
     {
         replacement = r;
@@ -359,77 +1065,98 @@ void BST<T>::erase(T k)
     // Case 3: n has left and right children
     else if (r != nullptr && l != nullptr)
     {
-        // In this case, we don't actually delete this node,
-        // instead we update it with the key of its successor and 
-        // delete the successor node
-        replacement = successor(k);
-        int new_key = replacement->key;
-        erase(new_key);
-        n->key = new_key;
-        fix_height(n);
-        return;
-    }
-
-    // Decide what to update
-    if (replacement == nullptr)
-    {
-        // If n is a leaf node, replacement is null
-        // update parent appropriately
-        if (parent->key > n->key)
-            parent->left = nullptr;
-        else
-            parent->right = nullptr;
-    }
-    else
-    {
-        // n is not a leaf node
-        // Update the parent node and also the replacement node pointers
-        if (parent == nullptr)
+        // In this case the successor, the minimum of the right
+        // subtree, leaves its own place and takes over n's children.
+        // It has no left child, so its right subtree takes its place.
+        replacement = min(r);
+        if (replacement != r)
         {
-            // n is actually the root node
-            root_ = replacement;
-            replacement->parent = nullptr;
+            lowest = replacement->parent;
+            lowest->left = replacement->right;
+            if (replacement->right != nullptr)
+                replacement->right->parent = lowest;
+            replacement->right = r;
+            r->parent = replacement;
         }
         else
-        {
-            if (parent->key > k)
-            {
-                // put replacement on the left side
-                parent->left = replacement;
-                replacement->parent = parent;
-            }
-            else
-            {
-                // put replacement on the right side
-                parent->right = replacement;
-                replacement->parent = parent;
-            }
-        }
+            lowest = replacement;
+        replacement->left = l;
+        l->parent = replacement;
+        // the height of the place it takes over, which stays right
+        // unless the fix below climbs through it
+        replacement->height = n->height;
     }
-    // Delete the node, update size and height
-    delete n;
+
+    // Update the parent node and also the replacement node pointers
+    if (replacement != nullptr)
+        replacement->parent = parent;
+    if (parent == nullptr)
+        root_ = replacement;
+    else if (parent->left == n)
+        parent->left = replacement;
+    else
+        parent->right = replacement;
+
     size_--;
-    fix_height(parent);
+    duplicates_ -= n->count - 1;
+    filter_erase();
+    if (splay_ && lowest != nullptr)
+    {
+        // splaying fixes every height above lowest
+        update_height(lowest);
+        splay(lowest);
+    }
+    else
+        fix_height_until_stable(lowest);
+
+    n->left = nullptr;
+    n->right = nullptr;
+    n->parent = nullptr;
+    n->height = 0;
+    return n;
 }
 
 //*** For you to implement
-template <typename T>
-void BST<T>::rotate_right(Node* node)
+template <typename T, typename Stats>
+void BST<T, Stats>::rotate_right(Node* node)
 {
     // Assumptions: node is not nullptr and must have a left child
+    link_rotate_right(node);
+    // node and its left child are correct, fix the ancestors
+    fix_height(node->parent->parent);
+}
 
-    // Node* move_up_node = node->left;  
-    
+template <typename T, typename Stats>
+void BST<T, Stats>::rotate_left(Node* node)
+{
+    // Assumptions: node is not nullptr and must have a right child
+    link_rotate_left(node);
+    fix_height(node->parent->parent);
+}
+
+template <typename T, typename Stats>
+void BST<T, Stats>::update_height(Node* n)
+{
+    int l_height = (n->left == nullptr) ? -1 : n->left->height;
+    int r_height = (n->right == nullptr) ? -1 : n->right->height;
+    n->height = std::max(l_height, r_height) + 1;
+    stats_.fix_height_step();
+}
+
+template <typename T, typename Stats>
+void BST<T, Stats>::link_rotate_right(Node* node)
+{
     // There are 3 pairs (parent and child) of pointers to change
     // 1) node's left child becomes move_up_node's right child
     // 2) node's original parent becomes move_up_node's parent
     // 3) move_up_node's right child becomes node
-
     Node* move_up_node = node->left;
     Node* parent = node->parent;
 
     // Binary tree right rotate
     node->left = move_up_node->right;
+    if (node->left != nullptr)
+        node->left->parent = node;
     move_up_node->right = node;
 
     // Update the parent of node 
@@ -439,85 +1166,602 @@ void BST<T>::rotate_right(Node* node)
     // handle node's original parent linkages
     if (parent == nullptr)
         root_ = move_up_node;
-    else if (parent->key > move_up_node->key)
+    else if (parent->left == node)
         parent->left = move_up_node;
     else
         parent->right = move_up_node;
-    
-    fix_height(node);
-
 
+    stats_.rotation();
+    // node is now below move_up_node, so it goes first
+    update_height(node);
+    update_height(move_up_node);
 }
 
-// The rest of the functions below are already implemented
-
-// returns a pointer to the minimum node
-template <typename T>
-typename BST<T>::Node* BST<T>::min()
+template <typename T, typename Stats>
+void BST<T, Stats>::link_rotate_left(Node* node)
 {
-    if(root_ == nullptr)
-    {
-        return root_;
-    }
+    // The mirror image of link_rotate_right
+    Node* move_up_node = node->right;
+    Node* parent = node->parent;
+
+    node->right = move_up_node->left;
+    if (node->right != nullptr)
+        node->right->parent = node;
+    move_up_node->left = node;
+
+    node->parent = move_up_node;
+    move_up_node->parent = parent;
+
+    if (parent == nullptr)
+        root_ = move_up_node;
+    else if (parent->left == node)
+        parent->left = move_up_node;
     else
-    {
-        return min(root_);
-    }
-}
+        parent->right = move_up_node;
 
-// returns pointer to minimum node in the subtree rooted by node
-// Assumes node is not nullptr
-template <typename T>
-typename BST<T>::Node* BST<T>::min(Node* node)
-{
-    while(node->left != nullptr)
-    {
-        node = node->left;
-    } 
-    return node;
+    stats_.rotation();
+    update_height(node);
+    update_height(move_up_node);
 }
 
-// returns a pointer to node with key k
-template <typename T>
-typename BST<T>::Node* BST<T>::find(T k)
+// Bottom-up splaying.  When node and its parent are children on the
+// same side (zig-zig) the grandparent is rotated first, otherwise
+// (zig-zag) the parent is.  Rotating the grandparent first is what
+// roughly halves the depth of every node on the path and gives the
+// amortised bound, rotating node up one level at a time would not.
+template <typename T, typename Stats>
+void BST<T, Stats>::splay(Node* node)
 {
-    Node* node = root_;  
-    while(node != nullptr && node->key != k)
+    while (node->parent != nullptr)
     {
-        node = k < node->key ?  node->left : node->right;
-    }
-    return node;  
-}
-
-template <typename T>
-unsigned BST<T>::size()
-{
-    return size_;
+        Node* parent = node->parent;
+        Node* grandparent = parent->parent;
+        bool node_left = (parent->left == node);
+        if (grandparent == nullptr)
+        {
+            // zig
+            if (node_left)
+                link_rotate_right(parent);
+            else
+                link_rotate_left(parent);
+        }
+        else if (node_left == (grandparent->left == parent))
+        {
+            // zig-zig
+            if (node_left)
+            {
+                link_rotate_right(grandparent);
+                link_rotate_right(parent);
+            }
+            else
+            {
+                link_rotate_left(grandparent);
+                link_rotate_left(parent);
+            }
+        }
+        else
+        {
+            // zig-zag
+            if (node_left)
+            {
+                link_rotate_right(parent);
+                link_rotate_left(grandparent);
+            }
+            else
+            {
+                link_rotate_left(parent);
+                link_rotate_right(grandparent);
+            }
+        }
+    }
 }
 
-// prints out the keys in the tree using in-order traversal
-template <typename T>
-void BST<T>::print()
+// If k is larger than the key of node, every key between node and
+// the nearest ancestor that has node in its left subtree lies in the
+// right subtree of node.  So climb past the ancestors that have node
+// in their right subtree, and if k is below the key of the ancestor
+// reached, the search continues down from node.  Otherwise that
+// ancestor becomes node and the same test is repeated from there.
+// Smaller keys are the mirror image.
+template <typename T, typename Stats>
+typename BST<T, Stats>::Node* BST<T, Stats>::finger_start(const T& k)
 {
-    print(root_);
+    Node* node = finger_;
+    while(node->key != k)
+    {
+        bool go_right = node->key < k;
+        Node* child = node;
+        while(child->parent != nullptr && (child->parent->right == child) == go_right)
+        {
+            child = child->parent;
+            stats_.visit();
+        }
+        Node* bound = child->parent;
+        if(bound == nullptr)
+        {
+            return node;
+        }
+        stats_.visit();
+        stats_.comparison();
+        if(go_right ? k < bound->key : bound->key < k)
+        {
+            return node;
+        }
+        node = bound;
+    }
+    return node;
 }
 
-// you can modify what is printed out to suit your needs
-template <typename T>
-void BST<T>::print(Node* node)
+template <typename T, typename Stats>
+void BST<T, Stats>::set_finger(bool on)
 {
-    if(node == nullptr)
+    use_finger_ = on;
+    finger_ = nullptr;
+}
+
+template <typename T, typename Stats>
+bool BST<T, Stats>::finger() const
+{
+    return use_finger_;
+}
+
+template <typename T, typename Stats>
+void BST<T, Stats>::set_filter(double false_positive_rate)
+{
+    static_assert(Is_filter_hashable<T>::value, "the membership filter needs std::hash of the key type");
+    if(false_positive_rate <= 0)
     {
+        filter_.reset();
         return;
     }
-    print(node->left);
-    std::cout << node->key << " height " << node->height << '\n';
-    print(node->right);
+    filter_.reset(new Key_filter(1, false_positive_rate));
+    rebuild_filter();
+    filter_->stats.rebuilds = 0;
+}
+
+template <typename T, typename Stats>
+Filter_stats BST<T, Stats>::filter_stats() const
+{
+    return (filter_ == nullptr) ? Filter_stats() : filter_->stats;
+}
+
+template <typename T, typename Stats>
+std::uint64_t BST<T, Stats>::filter_key(const T& k)
+{
+    if constexpr(Is_filter_hashable<T>::value)
+    {
+        return filter_hash(k);
+    }
+    else
+    {
+        return 0;
+    }
+}
+
+template <typename T, typename Stats>
+void BST<T, Stats>::filter_insert(const T& k)
+{
+    if(filter_ == nullptr)
+    {
+        return;
+    }
+    if(++filter_->added > filter_->bloom.capacity())
+    {
+        // the new key is already in the tree, so the rebuild adds it
+        rebuild_filter();
+        return;
+    }
+    filter_->bloom.insert(filter_key(k));
+}
+
+template <typename T, typename Stats>
+void BST<T, Stats>::filter_erase(std::size_t count)
+{
+    // erased keys stay in the filter and turn lookups for them
+    // into false positives, so rebuild once they outnumber the rest
+    if(filter_ != nullptr && (filter_->erased += count) > size_)
+    {
+        rebuild_filter();
+    }
+}
+
+template <typename T, typename Stats>
+void BST<T, Stats>::rebuild_filter()
+{
+    Filter_stats stats = filter_->stats;
+    stats.rebuilds++;
+    double rate = filter_->false_positive_rate;
+    std::size_t capacity = std::max<std::size_t>(2 * size_, 64);
+    filter_.reset(new Key_filter(capacity, rate));
+    if(root_ != nullptr)
+    {
+        for(Node* node = min(root_); node != nullptr; node = next_in_order(node))
+        {
+            filter_->bloom.insert(filter_key(node->key));
+        }
+    }
+    filter_->added = size_;
+    filter_->stats = stats;
+}
+
+template <typename T, typename Stats>
+void BST<T, Stats>::set_splay(bool on)
+{
+    splay_ = on;
+}
+
+template <typename T, typename Stats>
+bool BST<T, Stats>::splay() const
+{
+    return splay_;
+}
+
+template <typename T, typename Stats>
+void BST<T, Stats>::set_multiset(bool on)
+{
+    multiset_ = on;
+}
+
+template <typename T, typename Stats>
+bool BST<T, Stats>::multiset() const
+{
+    return multiset_;
+}
+
+template <typename T, typename Stats>
+unsigned BST<T, Stats>::count(T k)
+{
+    Node* node = find(k);
+    return (node == nullptr) ? 0 : node->count;
+}
+
+template <typename T, typename Stats>
+bool BST<T, Stats>::erase_one(T k)
+{
+    Node* node = find_node(k);
+    if(node == nullptr)
+    {
+        return false;
+    }
+    if(node->count == 1)
+    {
+        erase(k);
+        return true;
+    }
+    --node->count;
+    --duplicates_;
+    if(splay_)
+    {
+        splay(node);
+    }
+    return true;
+}
+
+template <typename T, typename Stats>
+unsigned BST<T, Stats>::erase_all(T k)
+{
+    Node* node = find_node(k);
+    if(node == nullptr)
+    {
+        return 0;
+    }
+    unsigned copies = node->count;
+    erase(k);
+    return copies;
+}
+
+// The rest of the functions below are already implemented
+
+// returns a pointer to the minimum node
+template <typename T, typename Stats>
+typename BST<T, Stats>::Node* BST<T, Stats>::min()
+{
+    return min_;
+}
+
+// returns a pointer to the maximum node
+template <typename T, typename Stats>
+typename BST<T, Stats>::Node* BST<T, Stats>::max()
+{
+    return max_;
+}
+
+template <typename T, typename Stats>
+bool BST<T, Stats>::pop_min(T& out)
+{
+    if(min_ == nullptr)
+    {
+        return false;
+    }
+    out = min_->key;
+    delete_min();
+    return true;
+}
+
+// The removed keys are exactly those below the key of the node that
+// follows the last one popped, call it the pivot.  Walking down from
+// the root, a node below the pivot goes together with its whole left
+// subtree and its right subtree takes its place, a node not below the
+// pivot stays and the walk carries on to its left.
+template <typename T, typename Stats>
+unsigned BST<T, Stats>::pop_min_n(unsigned k, std::vector<T>& out)
+{
+    unsigned removed = 0;
+    // the nodes emptied, all of them before pivot
+    unsigned nodes = 0;
+    Node* pivot = min_;
+    while(removed < k && pivot != nullptr)
+    {
+        unsigned copies = std::min(pivot->count, k - removed);
+        out.insert(out.end(), copies, pivot->key);
+        removed += copies;
+        if(copies < pivot->count)
+        {
+            // pivot keeps some of its copies and stays
+            pivot->count -= copies;
+            duplicates_ -= copies;
+            break;
+        }
+        duplicates_ -= copies - 1;
+        ++nodes;
+        pivot = next_in_order(pivot);
+    }
+    if(nodes == 0)
+    {
+        return removed;
+    }
+    finger_ = nullptr;
+    if(pivot == nullptr)
+    {
+        delete_subtree(root_);
+        root_ = nullptr;
+        max_ = nullptr;
+    }
+    else
+    {
+        // the counts were taken off above
+        unsigned cut_nodes = 0;
+        unsigned cut_copies = 0;
+        const T& pivot_key = pivot->key;
+        fix_height(cut_low(&root_, nullptr, [&pivot_key](const T& key) { return key < pivot_key; },
+                           cut_nodes, cut_copies));
+    }
+    min_ = pivot;
+    size_ -= nodes;
+    filter_erase(nodes);
+    return removed;
+}
+
+// Walking down from *link, a node whose key goes is freed together
+// with its whole left subtree and its right subtree takes its place, a
+// node that stays is kept and the walk carries on to its left.  The
+// kept nodes on the walk are the lowest one and its ancestors.
+template <typename T, typename Stats>
+template <typename Pred>
+typename BST<T, Stats>::Node* BST<T, Stats>::cut_low(Node** link, Node* parent, Pred low,
+                                                     unsigned& nodes, unsigned& copies)
+{
+    while(*link != nullptr)
+    {
+        Node* node = *link;
+        stats_.visit();
+        stats_.comparison();
+        if(low(node->key))
+        {
+            *link = node->right;
+            if(node->right != nullptr)
+            {
+                node->right->parent = parent;
+            }
+            node->right = nullptr;
+            nodes += free_subtree(node, copies);
+        }
+        else
+        {
+            parent = node;
+            link = &node->left;
+        }
+    }
+    return parent;
+}
+
+// The mirror image of cut_low
+template <typename T, typename Stats>
+template <typename Pred>
+typename BST<T, Stats>::Node* BST<T, Stats>::cut_high(Node** link, Node* parent, Pred high,
+                                                      unsigned& nodes, unsigned& copies)
+{
+    while(*link != nullptr)
+    {
+        Node* node = *link;
+        stats_.visit();
+        stats_.comparison();
+        if(high(node->key))
+        {
+            *link = node->left;
+            if(node->left != nullptr)
+            {
+                node->left->parent = parent;
+            }
+            node->left = nullptr;
+            nodes += free_subtree(node, copies);
+        }
+        else
+        {
+            parent = node;
+            link = &node->right;
+        }
+    }
+    return parent;
+}
+
+// The heights are fixed by the callers, so the extremes are found
+// again by walking down the outer paths.
+template <typename T, typename Stats>
+void BST<T, Stats>::after_cut(unsigned nodes, unsigned copies)
+{
+    finger_ = nullptr;
+    size_ -= nodes;
+    duplicates_ -= copies - nodes;
+    min_ = (root_ == nullptr) ? nullptr : min(root_);
+    max_ = root_;
+    while(max_ != nullptr && max_->right != nullptr)
+    {
+        max_ = max_->right;
+    }
+    filter_erase(nodes);
+}
+
+template <typename T, typename Stats>
+unsigned BST<T, Stats>::erase_below(T k)
+{
+    unsigned nodes = 0;
+    unsigned copies = 0;
+    fix_height(cut_low(&root_, nullptr, [&k](const T& key) { return key < k; }, nodes, copies));
+    after_cut(nodes, copies);
+    return copies;
+}
+
+template <typename T, typename Stats>
+unsigned BST<T, Stats>::erase_above(T k)
+{
+    unsigned nodes = 0;
+    unsigned copies = 0;
+    fix_height(cut_high(&root_, nullptr, [&k](const T& key) { return k < key; }, nodes, copies));
+    after_cut(nodes, copies);
+    return copies;
+}
+
+// The walk goes down to the highest node inside [a, b), the one where
+// the paths to a and to b part.  Below it the keys from a on are cut
+// from its left subtree and those below b from its right subtree, and
+// then the node itself is unlinked like any other.
+template <typename T, typename Stats>
+unsigned BST<T, Stats>::erase_range(T a, T b)
+{
+    Node* top = root_;
+    while(top != nullptr && (top->key < a || !(top->key < b)))
+    {
+        stats_.visit();
+        stats_.comparison();
+        top = (top->key < a) ? top->right : top->left;
+    }
+    if(top == nullptr)
+    {
+        return 0;
+    }
+    unsigned nodes = 0;
+    unsigned copies = 0;
+    fix_height(cut_high(&top->left, top, [&a](const T& key) { return !(key < a); }, nodes, copies));
+    fix_height(cut_low(&top->right, top, [&b](const T& key) { return key < b; }, nodes, copies));
+    after_cut(nodes, copies);
+    // unlink moves the extremes off top if it is one of them
+    copies += top->count;
+    delete unlink(top);
+    stats_.free();
+    return copies;
+}
+
+// returns pointer to minimum node in the subtree rooted by node
+// Assumes node is not nullptr
+template <typename T, typename Stats>
+typename BST<T, Stats>::Node* BST<T, Stats>::min(Node* node)
+{
+    while(node->left != nullptr)
+    {
+        node = node->left;
+        stats_.visit();
+    } 
+    return node;
+}
+
+// returns a pointer to node with key k
+// In splay mode the node found, or the last node visited if k is
+// not in the tree, is splayed to the root
+template <typename T, typename Stats>
+typename BST<T, Stats>::Node* BST<T, Stats>::find(T k)
+{
+    if(filter_ != nullptr)
+    {
+        filter_->stats.lookups++;
+        if(!filter_->bloom.may_contain(filter_key(k)))
+        {
+            filter_->stats.filtered++;
+            return nullptr;
+        }
+    }
+    Node* node = root_;  
+    Node* last = nullptr;
+    if(use_finger_ && finger_ != nullptr)
+    {
+        node = finger_start(k);
+    }
+    while(node != nullptr && node->key != k)
+    {
+        stats_.visit();
+        stats_.comparison();
+        last = node;
+        node = k < node->key ?  node->left : node->right;
+    }
+    if(filter_ != nullptr && node == nullptr)
+    {
+        filter_->stats.false_positives++;
+    }
+    if(use_finger_)
+    {
+        finger_ = (node != nullptr) ? node : last;
+    }
+    if(splay_ && (node != nullptr || last != nullptr))
+    {
+        splay(node != nullptr ? node : last);
+    }
+    return node;  
+}
+
+template <typename T, typename Stats>
+typename BST<T, Stats>::Node* BST<T, Stats>::find_node(const T& k)
+{
+    Node* node = root_;  
+    while(node != nullptr && node->key != k)
+    {
+        stats_.visit();
+        stats_.comparison();
+        node = k < node->key ?  node->left : node->right;
+    }
+    return node;  
+}
+
+template <typename T, typename Stats>
+unsigned BST<T, Stats>::size()
+{
+    return size_ + duplicates_;
+}
+
+template <typename T, typename Stats>
+unsigned BST<T, Stats>::distinct_size()
+{
+    return size_;
+}
+
+// prints out the keys in the tree using in-order traversal
+// you can modify what is printed out to suit your needs
+// The walk follows parent pointers, so deep trees need no recursion
+template <typename T, typename Stats>
+void BST<T, Stats>::print()
+{
+    Text_writer out(std::cout);
+    for(Node* node = min_; node != nullptr; node = next_in_order(node))
+    {
+        out.value(node->key);
+        out.text(" height ");
+        out.value(node->height);
+        out.text("\n");
+    }
 }
 
 // This is used in our testing, please do not modify
-template <typename T>
-typename std::vector<T> BST<T>::make_vec()
+template <typename T, typename Stats>
+typename std::vector<T> BST<T, Stats>::make_vec()
 {
     std::vector<T> vec;
     vec.reserve(size_);
@@ -526,8 +1770,8 @@ typename std::vector<T> BST<T>::make_vec()
 }
 
 // This is used for our testing, please do not modify
-template <typename T>
-void BST<T>::make_vec(Node* node, std::vector<T>& vec)
+template <typename T, typename Stats>
+void BST<T, Stats>::make_vec(Node* node, std::vector<T>& vec)
 {
     if(node == nullptr)
     {
@@ -539,9 +1783,79 @@ void BST<T>::make_vec(Node* node, std::vector<T>& vec)
     
 }
 
+template <typename T, typename Stats>
+typename std::vector<T> BST<T, Stats>::make_vec(bool expand)
+{
+    if(!expand)
+    {
+        return make_vec();
+    }
+    std::vector<T> vec;
+    vec.reserve(size_ + duplicates_);
+    for(Node* node = min_; node != nullptr; node = next_in_order(node))
+    {
+        vec.insert(vec.end(), node->count, node->key);
+    }
+    return vec;
+}
+
+#ifdef DSA_HAS_GENERATOR
+template <typename T, typename Stats>
+Generator<T> BST<T, Stats>::in_order()
+{
+    for(Node* node = min_; node != nullptr; node = next_in_order(node))
+    {
+        stats_.visit();
+        co_yield node->key;
+    }
+}
+
+// descends to the smallest key not below lo, then walks
+// forward until the first key that is not below hi
+template <typename T, typename Stats>
+Generator<T> BST<T, Stats>::range(T lo, T hi)
+{
+    Node* first = nullptr;
+    for(Node* node = root_; node != nullptr; )
+    {
+        stats_.visit();
+        stats_.comparison();
+        if(node->key < lo)
+        {
+            node = node->right;
+        }
+        else
+        {
+            first = node;
+            node = node->left;
+        }
+    }
+    for(Node* node = first; node != nullptr; node = next_in_order(node))
+    {
+        stats_.comparison();
+        if(!(node->key < hi))
+        {
+            co_return;
+        }
+        stats_.visit();
+        co_yield node->key;
+    }
+}
+
+template <typename T, typename Stats>
+Generator<T> BST<T, Stats>::reverse_order()
+{
+    for(Node* node = max_; node != nullptr; node = prev_in_order(node))
+    {
+        stats_.visit();
+        co_yield node->key;
+    }
+}
+#endif
+
 // This is used for our testing, please do not modify
-template <typename T>
-void BST<T>::your_postorder_heights(Node* node, std::vector<int>& vec)
+template <typename T, typename Stats>
+void BST<T, Stats>::your_postorder_heights(Node* node, std::vector<int>& vec)
 {
     if(node == nullptr)
     {
@@ -553,8 +1867,8 @@ void BST<T>::your_postorder_heights(Node* node, std::vector<int>& vec)
 }
 
 // This is used for our testing, please do not modify
-template <typename T>
-int BST<T>::real_postorder_heights(Node* node, std::vector<int>& vec)
+template <typename T, typename Stats>
+int BST<T, Stats>::real_postorder_heights(Node* node, std::vector<int>& vec)
 {
     if(node == nullptr)
     {
@@ -568,8 +1882,8 @@ int BST<T>::real_postorder_heights(Node* node, std::vector<int>& vec)
 }
 
 // This is used for our testing, please do not modify
-template <typename T>
-typename std::vector<int> BST<T>::your_postorder_heights()
+template <typename T, typename Stats>
+typename std::vector<int> BST<T, Stats>::your_postorder_heights()
 {
     std::vector<int> vec;
     vec.reserve(size_);
@@ -578,8 +1892,8 @@ typename std::vector<int> BST<T>::your_postorder_heights()
 }
 
 // This is used for our testing, please do not modify
-template <typename T>
-typename std::vector<int> BST<T>::real_postorder_heights()
+template <typename T, typename Stats>
+typename std::vector<int> BST<T, Stats>::real_postorder_heights()
 {
     std::vector<int> vec;
     vec.reserve(size_);
@@ -588,8 +1902,8 @@ typename std::vector<int> BST<T>::real_postorder_heights()
 }
 
 // This is used for our testing, please do not modify
-template <typename T>
-T BST<T>::get_root_value()
+template <typename T, typename Stats>
+T BST<T, Stats>::get_root_value()
 {
     if(root_ == nullptr)
     {
@@ -603,4 +1917,258 @@ T BST<T>::get_root_value()
     }
 }
 
+// Binary serialisation
+
+template <typename T, typename Stats>
+bool BST<T, Stats>::save(std::ostream& out) const
+{
+    Binary_writer writer(out);
+    return save_to(writer) && writer.flush();
+}
+
+template <typename T, typename Stats>
+bool BST<T, Stats>::save(int fd) const
+{
+    Binary_writer writer(fd);
+    return save_to(writer) && writer.flush();
+}
+
+template <typename T, typename Stats>
+bool BST<T, Stats>::load(std::istream& in)
+{
+    Binary_reader reader(in);
+    return load_from(reader);
+}
+
+template <typename T, typename Stats>
+bool BST<T, Stats>::load(int fd)
+{
+    Binary_reader reader(fd);
+    return load_from(reader);
+}
+
+// Text output
+
+template <typename T, typename Stats>
+bool BST<T, Stats>::write(std::ostream& out, const Text_options& options) const
+{
+    Text_writer writer(out, options);
+    return write_to(writer);
+}
+
+template <typename T, typename Stats>
+bool BST<T, Stats>::write(int fd, const Text_options& options) const
+{
+    Text_writer writer(fd, options);
+    return write_to(writer);
+}
+
+template <typename T, typename Stats>
+bool BST<T, Stats>::write_to(Text_writer& out) const
+{
+    out.begin();
+    for(Node* node = min_; node != nullptr; node = next_in_order(node))
+    {
+        if(!out.element(node->key))
+        {
+            return false;
+        }
+    }
+    return out.finish();
+}
+
+template <typename T, typename Stats>
+bool BST<T, Stats>::save_to(Binary_writer& out) const
+{
+    // plain sets keep the format without counts
+    const bool counted = duplicates_ > 0;
+    if(!write_binary_header<T>(out, counted ? "DSAM" : "DSAT", size_))
+    {
+        return false;
+    }
+    // iterative in-order traversal using the parent pointers
+    Node* node = root_;
+    if(node != nullptr)
+    {
+        while(node->left != nullptr)
+        {
+            node = node->left;
+        }
+    }
+    for(; node != nullptr; node = next_in_order(node))
+    {
+        if(!Binary_codec<T>::write(out, node->key) ||
+           (counted && !out.write(&node->count, sizeof(node->count))))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename T, typename Stats>
+bool BST<T, Stats>::load_from(Binary_reader& in)
+{
+    std::uint64_t count = 0;
+    bool counted = false;
+    if(!read_binary_header<T>(in, "DSAT", "DSAM", counted, count))
+    {
+        return false;
+    }
+    Node* prev = nullptr;
+    bool ok = true;
+    std::uint64_t copies = 0;
+    Node* new_root = build_balanced(in, count, counted, copies, prev, ok);
+    // size() must still fit in an unsigned
+    if(ok && count + copies > std::numeric_limits<unsigned>::max())
+    {
+        ok = false;
+    }
+    if(!ok)
+    {
+        delete_subtree(new_root);
+        return false;
+    }
+    delete_subtree(root_);
+    root_ = new_root;
+    size_ = count;
+    duplicates_ = copies;
+    finger_ = nullptr;
+    min_ = (root_ == nullptr) ? nullptr : min(root_);
+    max_ = root_;
+    while(max_ != nullptr && max_->right != nullptr)
+    {
+        max_ = max_->right;
+    }
+    if(filter_ != nullptr)
+    {
+        rebuild_filter();
+    }
+    return true;
+}
+
+// Builds the left half, then the middle node, then the right half,
+// so the keys are consumed in the order they were saved.
+// The recursion depth is only log2(count).
+template <typename T, typename Stats>
+typename BST<T, Stats>::Node* BST<T, Stats>::build_balanced(Binary_reader& in, std::uint64_t count,
+                                              bool counted, std::uint64_t& copies,
+                                              Node*& prev, bool& ok)
+{
+    if(count == 0 || !ok)
+    {
+        return nullptr;
+    }
+    std::uint64_t left_count = count / 2;
+    Node* node = new Node();
+    stats_.allocation();
+    node->left = build_balanced(in, left_count, counted, copies, prev, ok);
+    if(ok && (!Binary_codec<T>::read(in, node->key) ||
+              (prev != nullptr && !(prev->key < node->key))))
+    {
+        ok = false;
+    }
+    // every node holds at least one copy
+    if(ok && counted && (!in.read(&node->count, sizeof(node->count)) || node->count == 0))
+    {
+        ok = false;
+    }
+    if(ok)
+    {
+        copies += node->count - 1;
+    }
+    prev = node;
+    node->right = build_balanced(in, count - left_count - 1, counted, copies, prev, ok);
+
+    int l_height = -1;
+    int r_height = -1;
+    if(node->left != nullptr)
+    {
+        node->left->parent = node;
+        l_height = node->left->height;
+    }
+    if(node->right != nullptr)
+    {
+        node->right->parent = node;
+        r_height = node->right->height;
+    }
+    node->height = std::max(l_height, r_height) + 1;
+    return node;
+}
+
+template <typename T, typename Stats>
+typename BST<T, Stats>::Node* BST<T, Stats>::next_in_order(Node* node)
+{
+    if(node->right != nullptr)
+    {
+        node = node->right;
+        while(node->left != nullptr)
+        {
+            node = node->left;
+        }
+        return node;
+    }
+    while(node->parent != nullptr && node->parent->right == node)
+    {
+        node = node->parent;
+    }
+    return node->parent;
+}
+
+template <typename T, typename Stats>
+typename BST<T, Stats>::Node* BST<T, Stats>::prev_in_order(Node* node)
+{
+    if(node->left != nullptr)
+    {
+        node = node->left;
+        while(node->right != nullptr)
+        {
+            node = node->right;
+        }
+        return node;
+    }
+    while(node->parent != nullptr && node->parent->left == node)
+    {
+        node = node->parent;
+    }
+    return node->parent;
+}
+
+// Statistics
+
+template <typename T, typename Stats>
+Container_stats BST<T, Stats>::stats() const
+{
+    return stats_.snapshot();
+}
+
+template <typename T, typename Stats>
+void BST<T, Stats>::reset_stats()
+{
+    stats_.reset();
+}
+
+// Memory footprint
+
+template <typename T, typename Stats>
+Memory_usage BST<T, Stats>::memory_usage() const
+{
+    Memory_usage m = node_memory_usage<Node, T>(size_, 3 * sizeof(Node*),
+                                                 sizeof(int) + sizeof(unsigned));
+    add_container_bytes(m, sizeof(*this));
+    if(filter_ != nullptr)
+    {
+        add_container_bytes(m, 0, sizeof(Key_filter));
+        add_container_bytes(m, 0, filter_->bloom.bytes());
+    }
+    if constexpr(Heap_usage<T>::enabled)
+    {
+        for(Node* node = min_; node != nullptr; node = next_in_order(node))
+        {
+            add_heap_usage(m, node->key);
+        }
+    }
+    return m;
+}
+
 #endif
@@ -0,0 +1,430 @@
+#ifndef PERSISTENT_BST_HPP
+#define PERSISTENT_BST_HPP
+
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <atomic>
+#include <mutex>
+
+// A persistent (path-copying) version of BST.
+// Once a node is reachable from a published root it is never modified.
+// insert and erase copy only the nodes on the search path from the root,
+// share every other subtree with the previous version, and then publish
+// the new root.  Older versions stay readable through Snapshot handles.
+// Every node carries a reference count (one per parent pointing at it plus
+// one per root or snapshot holding it), and a node is freed as soon as its
+// count drops to zero.
+template <typename T>
+class Persistent_BST
+{
+public:
+    // Nodes have no parent pointer, as a shared node can have
+    // a different parent in every version of the tree.
+    class Node
+    {
+    public:
+        T key;
+        int height = 0;
+        const Node* left = nullptr;
+        const Node* right = nullptr;
+        // number of parents, roots and snapshots referring to this node
+        mutable std::atomic<unsigned> refs {1};
+
+        // The new node takes over a reference to left and right,
+        // so the caller must already hold one for each of them
+        Node(const T& k, const Node* l, const Node* r)
+            : key(k), left(l), right(r)
+        {
+            int l_height = (l == nullptr) ? -1 : l->height;
+            int r_height = (r == nullptr) ? -1 : r->height;
+            height = std::max(l_height, r_height) + 1;
+        }
+    };
+
+    // A read-only view of the tree as it was when snapshot() was called.
+    // Copying a snapshot is O(1) and the view is unaffected by any later
+    // insert or erase on the tree it was taken from.  A snapshot may
+    // outlive the tree itself.
+    class Snapshot
+    {
+    public:
+        Snapshot() {}
+        Snapshot(const Snapshot& other);
+        Snapshot& operator=(const Snapshot& other);
+        ~Snapshot();
+
+        // Same meaning as the corresponding functions of BST
+        const Node* find(T k) const;
+        const Node* successor(T k) const;
+        const Node* min() const;
+        unsigned size() const;
+        std::vector<T> make_vec() const;
+
+    private:
+        friend class Persistent_BST;
+        // takes over a reference to root that the caller already holds
+        Snapshot(const Node* root, unsigned size) : root_(root), size_(size) {}
+
+        const Node* root_ = nullptr;
+        unsigned size_ = 0;
+    };
+
+private:
+    // root_ and size_ describe the current version.
+    // write_mutex_ serialises insert and erase, root_mutex_ guards
+    // publishing a new root against snapshot() taking a reference to it.
+    const Node* root_ = nullptr;
+    unsigned int size_ = 0;
+    std::mutex write_mutex_;
+    mutable std::mutex root_mutex_;
+
+public:
+    Persistent_BST() {}
+
+    // Drops the reference of the current version.  Nodes still used
+    // by live snapshots are freed when the last snapshot goes away.
+    ~Persistent_BST();
+
+    Persistent_BST(const Persistent_BST&) = delete;
+    Persistent_BST& operator=(const Persistent_BST&) = delete;
+
+    // insert the key k, copying the O(depth) nodes on the search path
+    // Like BST, if k is already in the tree then no action is taken
+    void insert(T k);
+
+    // erase the key k, copying the O(depth) nodes on the search path
+    // If k is not in the tree nothing happens
+    void erase(T k);
+
+    // Returns an O(1) handle on the current version of the tree
+    Snapshot snapshot() const;
+
+    // Returns the number of keys in the current version
+    unsigned size() const;
+
+private:
+    // publishes new_root as the current version and drops the
+    // reference held on the previous one
+    void publish(const Node* new_root, unsigned new_size);
+
+    // walks from root towards k and records every node visited in path
+    // returns the node holding k, or nullptr if k is not present
+    static const Node* find_path(const Node* root, const T& k,
+                                 std::vector<const Node*>& path);
+
+    // copies the nodes in path bottom up, hanging child where the last
+    // node of path led the search, and returns the new root
+    static const Node* copy_path(const std::vector<const Node*>& path,
+                                 const T& k, const Node* child);
+
+    // returns a copy of the subtree rooted at node with its minimum removed
+    // The caller must make sure that node is not nullptr
+    static const Node* copy_without_min(const Node* node);
+
+    static void acquire(const Node* node);
+
+    // drops a reference to node and frees every node that
+    // is no longer referenced, without recursion
+    static void release(const Node* node);
+
+    static const Node* min(const Node* node);
+
+    static void make_vec(const Node* node, std::vector<T>& vec);
+};
+
+template <typename T>
+Persistent_BST<T>::~Persistent_BST()
+{
+    release(root_);
+}
+
+template <typename T>
+void Persistent_BST<T>::insert(T k)
+{
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    std::vector<const Node*> path;
+    if(find_path(root_, k, path) != nullptr)
+    {
+        // item already in set
+        return;
+    }
+    const Node* leaf = new Node(k, nullptr, nullptr);
+    publish(copy_path(path, k, leaf), size_ + 1);
+}
+
+template <typename T>
+void Persistent_BST<T>::erase(T k)
+{
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    std::vector<const Node*> path;
+    const Node* n = find_path(root_, k, path);
+    if(n == nullptr)
+    {
+        return;
+    }
+    // path ends with n itself, the copy of the path stops at its parent
+    path.pop_back();
+
+    const Node* replacement = nullptr;
+    if(n->left == nullptr || n->right == nullptr)
+    {
+        // at most one child, which simply moves up into n's place
+        replacement = (n->left != nullptr) ? n->left : n->right;
+        acquire(replacement);
+    }
+    else
+    {
+        // two children: the successor of k takes n's place
+        const Node* succ = min(n->right);
+        const Node* new_right = copy_without_min(n->right);
+        acquire(n->left);
+        replacement = new Node(succ->key, n->left, new_right);
+    }
+    publish(copy_path(path, k, replacement), size_ - 1);
+}
+
+template <typename T>
+typename Persistent_BST<T>::Snapshot Persistent_BST<T>::snapshot() const
+{
+    std::lock_guard<std::mutex> lock(root_mutex_);
+    acquire(root_);
+    return Snapshot(root_, size_);
+}
+
+template <typename T>
+unsigned Persistent_BST<T>::size() const
+{
+    std::lock_guard<std::mutex> lock(root_mutex_);
+    return size_;
+}
+
+template <typename T>
+void Persistent_BST<T>::publish(const Node* new_root, unsigned new_size)
+{
+    const Node* old_root = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(root_mutex_);
+        old_root = root_;
+        root_ = new_root;
+        size_ = new_size;
+    }
+    // Nodes of the old version that were copied are freed here,
+    // unless a snapshot still refers to them
+    release(old_root);
+}
+
+template <typename T>
+const typename Persistent_BST<T>::Node* Persistent_BST<T>::find_path(
+    const Node* root, const T& k, std::vector<const Node*>& path)
+{
+    const Node* node = root;
+    while(node != nullptr)
+    {
+        path.push_back(node);
+        if(k < node->key)
+        {
+            node = node->left;
+        }
+        else if(k > node->key)
+        {
+            node = node->right;
+        }
+        else
+        {
+            return node;
+        }
+    }
+    return nullptr;
+}
+
+template <typename T>
+const typename Persistent_BST<T>::Node* Persistent_BST<T>::copy_path(
+    const std::vector<const Node*>& path, const T& k, const Node* child)
+{
+    // child is already owned by us, each copy takes over the
+    // reference to the copy below it and acquires the untouched sibling
+    for(auto it = path.rbegin(); it != path.rend(); ++it)
+    {
+        const Node* p = *it;
+        if(k < p->key)
+        {
+            acquire(p->right);
+            child = new Node(p->key, child, p->right);
+        }
+        else
+        {
+            acquire(p->left);
+            child = new Node(p->key, p->left, child);
+        }
+    }
+    return child;
+}
+
+template <typename T>
+const typename Persistent_BST<T>::Node* Persistent_BST<T>::copy_without_min(const Node* node)
+{
+    std::vector<const Node*> path;
+    while(node->left != nullptr)
+    {
+        path.push_back(node);
+        node = node->left;
+    }
+    // the minimum is replaced by its right subtree
+    const Node* child = node->right;
+    acquire(child);
+    for(auto it = path.rbegin(); it != path.rend(); ++it)
+    {
+        acquire((*it)->right);
+        child = new Node((*it)->key, child, (*it)->right);
+    }
+    return child;
+}
+
+template <typename T>
+void Persistent_BST<T>::acquire(const Node* node)
+{
+    if(node != nullptr)
+    {
+        node->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+template <typename T>
+void Persistent_BST<T>::release(const Node* node)
+{
+    std::vector<const Node*> pending;
+    while(true)
+    {
+        if(node != nullptr &&
+           node->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            pending.push_back(node->left);
+            pending.push_back(node->right);
+            delete node;
+        }
+        if(pending.empty())
+        {
+            return;
+        }
+        node = pending.back();
+        pending.pop_back();
+    }
+}
+
+template <typename T>
+const typename Persistent_BST<T>::Node* Persistent_BST<T>::min(const Node* node)
+{
+    while(node->left != nullptr)
+    {
+        node = node->left;
+    }
+    return node;
+}
+
+template <typename T>
+void Persistent_BST<T>::make_vec(const Node* node, std::vector<T>& vec)
+{
+    if(node == nullptr)
+    {
+        return;
+    }
+    make_vec(node->left, vec);
+    vec.push_back(node->key);
+    make_vec(node->right, vec);
+}
+
+// Snapshot
+
+template <typename T>
+Persistent_BST<T>::Snapshot::Snapshot(const Snapshot& other)
+    : root_(other.root_), size_(other.size_)
+{
+    acquire(root_);
+}
+
+template <typename T>
+typename Persistent_BST<T>::Snapshot& Persistent_BST<T>::Snapshot::operator=(const Snapshot& other)
+{
+    // acquire first so that self assignment is harmless
+    acquire(other.root_);
+    release(root_);
+    root_ = other.root_;
+    size_ = other.size_;
+    return *this;
+}
+
+template <typename T>
+Persistent_BST<T>::Snapshot::~Snapshot()
+{
+    release(root_);
+}
+
+template <typename T>
+const typename Persistent_BST<T>::Node* Persistent_BST<T>::Snapshot::find(T k) const
+{
+    const Node* node = root_;
+    while(node != nullptr && node->key != k)
+    {
+        node = k < node->key ?  node->left : node->right;
+    }
+    return node;
+}
+
+// Without parent pointers the successor is the last node
+// where the search for k turned left
+template <typename T>
+const typename Persistent_BST<T>::Node* Persistent_BST<T>::Snapshot::successor(T k) const
+{
+    const Node* node = root_;
+    const Node* last_left = nullptr;
+    while(node != nullptr && node->key != k)
+    {
+        if(k < node->key)
+        {
+            last_left = node;
+            node = node->left;
+        }
+        else
+        {
+            node = node->right;
+        }
+    }
+    if(node == nullptr)
+    {
+        // k is not in the tree
+        return nullptr;
+    }
+    if(node->right != nullptr)
+    {
+        return Persistent_BST<T>::min(node->right);
+    }
+    return last_left;
+}
+
+template <typename T>
+const typename Persistent_BST<T>::Node* Persistent_BST<T>::Snapshot::min() const
+{
+    if(root_ == nullptr)
+    {
+        return root_;
+    }
+    return Persistent_BST<T>::min(root_);
+}
+
+template <typename T>
+unsigned Persistent_BST<T>::Snapshot::size() const
+{
+    return size_;
+}
+
+template <typename T>
+std::vector<T> Persistent_BST<T>::Snapshot::make_vec() const
+{
+    std::vector<T> vec;
+    vec.reserve(size_);
+    Persistent_BST<T>::make_vec(root_, vec);
+    return vec;
+}
+
+#endif
@@ -0,0 +1,578 @@
+#ifndef RCU_BST_HPP
+#define RCU_BST_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A read-copy-update version of BST for trees that are read far more
+// often than they are written.
+//
+// Like Persistent_BST, insert and erase copy the nodes on the search
+// path and publish the new version with one atomic store, so
+// a node that readers can reach is never modified.  Readers load the
+// current version (acquire) and search it without taking a lock and
+// without touching any shared counter.
+//
+// Nodes replaced by a write cannot be freed at once, as a reader may
+// still be walking the old version.  They are retired instead, tagged
+// with the global epoch, and the epoch is moved on.  Each reader owns a
+// slot on a cache line of its own, where it records the epoch in which
+// its current read began, or 0 while it is not reading.  Nodes retired
+// in epoch e are freed once no slot holds an epoch of e or earlier,
+// which is the grace period: every read that could have seen them has
+// finished.  The slots are written only by their reader and read only
+// by the writer while reclaiming, so reads never share a written line.
+//
+//     Rcu_BST<int> tree;
+//     tree.insert(5);                     // writer
+//     Rcu_BST<int>::Reader reader(tree);  // one per reading thread
+//     if(reader.contains(5)) ...
+//
+// Writes are serialised by a mutex, the intended use being one writer.
+template <typename T>
+class Rcu_BST
+{
+public:
+    class Node
+    {
+    public:
+        T key;
+        const Node* left = nullptr;
+        const Node* right = nullptr;
+
+        Node(const T& k, const Node* l, const Node* r) : key(k), left(l), right(r) {}
+    };
+
+private:
+    // one published version: the root and the number of keys
+    struct Version
+    {
+        const Node* root;
+        unsigned size;
+    };
+
+    struct alignas(64) Slot
+    {
+        std::atomic<bool> taken {false};
+        // epoch the current read began in, 0 while not reading
+        std::atomic<std::uint64_t> epoch {0};
+    };
+
+    // the nodes and version a write replaced, and its epoch
+    struct Retired
+    {
+        std::uint64_t epoch;
+        const Version* version;
+        std::vector<const Node*> nodes;
+    };
+
+public:
+    // A handle for one reading thread.  It claims a reader slot of the
+    // tree, and every function is one read-side critical section.
+    // A Reader must not be shared between threads, and must not
+    // outlive its tree.
+    class Reader
+    {
+    public:
+        explicit Reader(Rcu_BST& tree);
+        ~Reader();
+
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        // false if the tree had no free reader slot, see max_readers;
+        // the functions below then answer as for an empty tree
+        bool valid() const;
+
+        bool contains(T k);
+
+        // stores the smallest key larger than k in out
+        // Returns false, leaving out alone, if there is none
+        bool successor(T k, T& out);
+
+        // calls fn(key) for the keys lo <= key < hi in increasing order,
+        // all from the same version of the tree, and returns their number
+        template <typename Fn>
+        unsigned range(T lo, T hi, Fn fn);
+
+        unsigned size();
+        std::vector<T> make_vec();
+
+    private:
+        // records the epoch in the slot and loads the current version
+        const Version* enter();
+        void leave();
+
+        Rcu_BST& tree_;
+        Slot* slot_ = nullptr;
+    };
+
+    // max_readers Readers can exist at the same time
+    explicit Rcu_BST(unsigned max_readers = 64);
+
+    // Frees every node.  No Reader may be left.
+    ~Rcu_BST();
+
+    Rcu_BST(const Rcu_BST&) = delete;
+    Rcu_BST& operator=(const Rcu_BST&) = delete;
+
+    // insert the key k, copying the O(depth) nodes on the search path
+    // Like BST, if k is already in the tree then no action is taken
+    void insert(T k);
+
+    // erase the key k, copying the O(depth) nodes on the search path
+    // If k is not in the tree nothing happens
+    void erase(T k);
+
+    // waits until every node retired so far has been freed, which
+    // needs each read that was running to finish
+    void synchronize();
+
+    // number of nodes retired but not yet freed
+    std::size_t pending() const;
+
+private:
+    // publishes new_root, retiring the previous version and garbage,
+    // the nodes of the previous version that the new one does not use
+    void publish(const Node* new_root, unsigned new_size, std::vector<const Node*>& garbage);
+
+    // frees the retired batches whose grace period is over
+    void reclaim();
+
+    // the oldest epoch a read in progress began in, or UINT64_MAX
+    std::uint64_t oldest_reader() const;
+
+    // as in Persistent_BST, but the copied nodes are also added to garbage
+    static const Node* find_path(const Node* root, const T& k, std::vector<const Node*>& path);
+    static const Node* copy_path(const std::vector<const Node*>& path, const T& k,
+                                 const Node* child, std::vector<const Node*>& garbage);
+    static const Node* copy_without_min(const Node* node, std::vector<const Node*>& garbage);
+
+    // frees a whole tree without recursion
+    static void delete_tree(const Node* node);
+
+    std::atomic<const Version*> version_;
+    // epochs start at 1, as a slot holding 0 means "not reading"
+    std::atomic<std::uint64_t> epoch_ {1};
+    std::unique_ptr<Slot[]> slots_;
+    unsigned slot_count_;
+    mutable std::mutex write_mutex_;
+    std::vector<Retired> retired_;
+};
+
+template <typename T>
+Rcu_BST<T>::Rcu_BST(unsigned max_readers)
+    : version_(new Version {nullptr, 0}),
+      slots_(new Slot[std::max(max_readers, 1u)]),
+      slot_count_(std::max(max_readers, 1u))
+{
+}
+
+template <typename T>
+Rcu_BST<T>::~Rcu_BST()
+{
+    for(Retired& r : retired_)
+    {
+        delete r.version;
+        for(const Node* node : r.nodes)
+        {
+            delete node;
+        }
+    }
+    const Version* v = version_.load(std::memory_order_relaxed);
+    delete_tree(v->root);
+    delete v;
+}
+
+template <typename T>
+void Rcu_BST<T>::insert(T k)
+{
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    const Version* v = version_.load(std::memory_order_relaxed);
+    std::vector<const Node*> path;
+    if(find_path(v->root, k, path) != nullptr)
+    {
+        // item already in set
+        return;
+    }
+    std::vector<const Node*> garbage;
+    const Node* leaf = new Node(k, nullptr, nullptr);
+    publish(copy_path(path, k, leaf, garbage), v->size + 1, garbage);
+}
+
+template <typename T>
+void Rcu_BST<T>::erase(T k)
+{
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    const Version* v = version_.load(std::memory_order_relaxed);
+    std::vector<const Node*> path;
+    const Node* n = find_path(v->root, k, path);
+    if(n == nullptr)
+    {
+        return;
+    }
+    // path ends with n itself, the copy of the path stops at its parent
+    path.pop_back();
+    std::vector<const Node*> garbage {n};
+
+    const Node* replacement = nullptr;
+    if(n->left == nullptr || n->right == nullptr)
+    {
+        // at most one child, which simply moves up into n's place
+        replacement = (n->left != nullptr) ? n->left : n->right;
+    }
+    else
+    {
+        // two children: the successor of k takes n's place
+        const Node* succ = n->right;
+        while(succ->left != nullptr)
+        {
+            succ = succ->left;
+        }
+        const Node* new_right = copy_without_min(n->right, garbage);
+        replacement = new Node(succ->key, n->left, new_right);
+    }
+    publish(copy_path(path, k, replacement, garbage), v->size - 1, garbage);
+}
+
+template <typename T>
+void Rcu_BST<T>::synchronize()
+{
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    while(!retired_.empty())
+    {
+        reclaim();
+        if(!retired_.empty())
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+template <typename T>
+std::size_t Rcu_BST<T>::pending() const
+{
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    std::size_t count = 0;
+    for(const Retired& r : retired_)
+    {
+        count += r.nodes.size();
+    }
+    return count;
+}
+
+template <typename T>
+void Rcu_BST<T>::publish(const Node* new_root, unsigned new_size, std::vector<const Node*>& garbage)
+{
+    const Version* old = version_.load(std::memory_order_relaxed);
+    version_.store(new Version {new_root, new_size}, std::memory_order_seq_cst);
+    // A read that sees the new epoch also sees the new version, so
+    // only reads that began in this epoch or earlier can hold old nodes
+    std::uint64_t e = epoch_.fetch_add(1, std::memory_order_seq_cst);
+    retired_.push_back(Retired {e, old, std::move(garbage)});
+    reclaim();
+}
+
+template <typename T>
+void Rcu_BST<T>::reclaim()
+{
+    std::uint64_t oldest = oldest_reader();
+    // batches are in epoch order, so the free ones are a prefix
+    std::size_t done = 0;
+    while(done < retired_.size() && retired_[done].epoch < oldest)
+    {
+        delete retired_[done].version;
+        for(const Node* node : retired_[done].nodes)
+        {
+            delete node;
+        }
+        ++done;
+    }
+    retired_.erase(retired_.begin(), retired_.begin() + done);
+}
+
+template <typename T>
+std::uint64_t Rcu_BST<T>::oldest_reader() const
+{
+    std::uint64_t oldest = UINT64_MAX;
+    for(unsigned i = 0; i < slot_count_; ++i)
+    {
+        std::uint64_t e = slots_[i].epoch.load(std::memory_order_seq_cst);
+        if(e != 0)
+        {
+            oldest = std::min(oldest, e);
+        }
+    }
+    return oldest;
+}
+
+template <typename T>
+const typename Rcu_BST<T>::Node* Rcu_BST<T>::find_path(
+    const Node* root, const T& k, std::vector<const Node*>& path)
+{
+    const Node* node = root;
+    while(node != nullptr)
+    {
+        path.push_back(node);
+        if(k < node->key)
+        {
+            node = node->left;
+        }
+        else if(node->key < k)
+        {
+            node = node->right;
+        }
+        else
+        {
+            return node;
+        }
+    }
+    return nullptr;
+}
+
+template <typename T>
+const typename Rcu_BST<T>::Node* Rcu_BST<T>::copy_path(
+    const std::vector<const Node*>& path, const T& k, const Node* child,
+    std::vector<const Node*>& garbage)
+{
+    for(auto it = path.rbegin(); it != path.rend(); ++it)
+    {
+        const Node* p = *it;
+        garbage.push_back(p);
+        if(k < p->key)
+        {
+            child = new Node(p->key, child, p->right);
+        }
+        else
+        {
+            child = new Node(p->key, p->left, child);
+        }
+    }
+    return child;
+}
+
+template <typename T>
+const typename Rcu_BST<T>::Node* Rcu_BST<T>::copy_without_min(
+    const Node* node, std::vector<const Node*>& garbage)
+{
+    std::vector<const Node*> path;
+    while(node->left != nullptr)
+    {
+        path.push_back(node);
+        node = node->left;
+    }
+    // the minimum is replaced by its right subtree
+    garbage.push_back(node);
+    const Node* child = node->right;
+    for(auto it = path.rbegin(); it != path.rend(); ++it)
+    {
+        garbage.push_back(*it);
+        child = new Node((*it)->key, child, (*it)->right);
+    }
+    return child;
+}
+
+template <typename T>
+void Rcu_BST<T>::delete_tree(const Node* node)
+{
+    std::vector<const Node*> pending;
+    while(node != nullptr || !pending.empty())
+    {
+        if(node == nullptr)
+        {
+            node = pending.back();
+            pending.pop_back();
+        }
+        if(node->right != nullptr)
+        {
+            pending.push_back(node->right);
+        }
+        const Node* left = node->left;
+        delete node;
+        node = left;
+    }
+}
+
+// Reader
+
+template <typename T>
+Rcu_BST<T>::Reader::Reader(Rcu_BST& tree) : tree_(tree)
+{
+    for(unsigned i = 0; i < tree_.slot_count_; ++i)
+    {
+        bool expected = false;
+        if(tree_.slots_[i].taken.compare_exchange_strong(expected, true, std::memory_order_acquire))
+        {
+            slot_ = &tree_.slots_[i];
+            return;
+        }
+    }
+}
+
+template <typename T>
+Rcu_BST<T>::Reader::~Reader()
+{
+    if(slot_ != nullptr)
+    {
+        slot_->taken.store(false, std::memory_order_release);
+    }
+}
+
+template <typename T>
+bool Rcu_BST<T>::Reader::valid() const
+{
+    return slot_ != nullptr;
+}
+
+template <typename T>
+const typename Rcu_BST<T>::Version* Rcu_BST<T>::Reader::enter()
+{
+    if(slot_ == nullptr)
+    {
+        return nullptr;
+    }
+    // Storing the slot and loading the version are sequentially
+    // consistent, like the writer's publish and its scan of the slots,
+    // so either the scan sees this slot or this read sees the version
+    // published before the scan.  On x86 only the store costs a fence,
+    // on a cache line no other reader writes.
+    slot_->epoch.store(tree_.epoch_.load(std::memory_order_acquire), std::memory_order_seq_cst);
+    return tree_.version_.load(std::memory_order_seq_cst);
+}
+
+template <typename T>
+void Rcu_BST<T>::Reader::leave()
+{
+    if(slot_ != nullptr)
+    {
+        slot_->epoch.store(0, std::memory_order_release);
+    }
+}
+
+template <typename T>
+bool Rcu_BST<T>::Reader::contains(T k)
+{
+    const Version* v = enter();
+    const Node* node = (v == nullptr) ? nullptr : v->root;
+    while(node != nullptr && (k < node->key || node->key < k))
+    {
+        node = k < node->key ? node->left : node->right;
+    }
+    bool found = node != nullptr;
+    leave();
+    return found;
+}
+
+// Without parent pointers the successor is the smallest key
+// larger than k on the search path, as in Persistent_BST
+template <typename T>
+bool Rcu_BST<T>::Reader::successor(T k, T& out)
+{
+    const Version* v = enter();
+    const Node* node = (v == nullptr) ? nullptr : v->root;
+    const Node* last_left = nullptr;
+    while(node != nullptr)
+    {
+        if(k < node->key)
+        {
+            last_left = node;
+            node = node->left;
+        }
+        else
+        {
+            node = node->right;
+        }
+    }
+    if(last_left != nullptr)
+    {
+        out = last_left->key;
+    }
+    leave();
+    return last_left != nullptr;
+}
+
+template <typename T>
+template <typename Fn>
+unsigned Rcu_BST<T>::Reader::range(T lo, T hi, Fn fn)
+{
+    const Version* v = enter();
+    unsigned count = 0;
+    // an explicit stack of the nodes still to visit, as there
+    // are no parent pointers to climb back up
+    std::vector<const Node*> stack;
+    const Node* node = (v == nullptr) ? nullptr : v->root;
+    while(node != nullptr || !stack.empty())
+    {
+        // down to the smallest key not below lo
+        while(node != nullptr)
+        {
+            if(node->key < lo)
+            {
+                node = node->right;
+            }
+            else
+            {
+                stack.push_back(node);
+                node = node->left;
+            }
+        }
+        if(stack.empty())
+        {
+            break;
+        }
+        node = stack.back();
+        stack.pop_back();
+        if(!(node->key < hi))
+        {
+            break;
+        }
+        fn(node->key);
+        ++count;
+        node = node->right;
+    }
+    leave();
+    return count;
+}
+
+template <typename T>
+unsigned Rcu_BST<T>::Reader::size()
+{
+    const Version* v = enter();
+    unsigned n = (v == nullptr) ? 0 : v->size;
+    leave();
+    return n;
+}
+
+template <typename T>
+std::vector<T> Rcu_BST<T>::Reader::make_vec()
+{
+    std::vector<T> vec;
+    const Version* v = enter();
+    if(v != nullptr)
+    {
+        vec.reserve(v->size);
+        std::vector<const Node*> stack;
+        const Node* node = v->root;
+        while(node != nullptr || !stack.empty())
+        {
+            while(node != nullptr)
+            {
+                stack.push_back(node);
+                node = node->left;
+            }
+            node = stack.back();
+            stack.pop_back();
+            vec.push_back(node->key);
+            node = node->right;
+        }
+    }
+    leave();
+    return vec;
+}
+
+#endif
@@ -0,0 +1,380 @@
+#ifndef SHARDED_BST_HPP
+#define SHARDED_BST_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+#include <vector>
+#include "bst.hpp"
+
+// An ordered set split by key range over several BSTs, so that threads
+// inserting into different parts of the key space do not wait for each
+// other.
+//
+// Shard i holds the keys k with splitter i-1 <= k < splitter i, each
+// shard has its own mutex, and insert, contains and erase lock only the
+// shard of their key.  The splitters are quantiles of the keys, taken
+// from a sample given to the constructor or, without one, from the
+// first keys inserted.  When a shard grows past twice its fair share
+// the set is rebalanced: new splitters are chosen from all keys and the
+// shards are rebuilt.  The layout of splitters and shards is guarded by
+// a shared_mutex, taken shared by every operation and exclusively only
+// by rebalance.
+//
+// min, delete_min, successor and for_each walk the shards in key order.
+// As they lock one shard at a time they see each shard at a different
+// moment, so with concurrent inserts of smaller keys delete_min may not
+// return the smallest key present at the end of the call.
+template <typename T>
+class Sharded_BST
+{
+public:
+    // shards shards, with splitters taken from sample if it is not
+    // empty, otherwise from the first keys inserted
+    explicit Sharded_BST(unsigned shards = 8, std::vector<T> sample = std::vector<T>());
+
+    Sharded_BST(const Sharded_BST&) = delete;
+    Sharded_BST& operator=(const Sharded_BST&) = delete;
+
+    // Like BST, if k is already in the set then no action is taken
+    void insert(T k);
+
+    bool contains(T k);
+
+    // If k is not in the set nothing happens
+    void erase(T k);
+
+    unsigned size();
+
+    // stores the minimum in out, returns false if the set is empty
+    bool min(T& out);
+
+    // removes the minimum and stores it in out, returns false if the
+    // set is empty
+    bool delete_min(T& out);
+
+    // As BST::successor: stores the smallest key larger than k in out,
+    // and returns false if k is the largest key or not in the set
+    bool successor(T k, T& out);
+
+    // calls fn(key) for every key in increasing order
+    template <typename Fn>
+    void for_each(Fn fn);
+
+    std::vector<T> make_vec();
+
+    // chooses new splitters from all keys so that every shard holds
+    // the same number of them, and rebuilds the shards
+    void rebalance();
+
+    // the number of keys in each shard, for monitoring skew
+    std::vector<unsigned> shard_sizes();
+
+    unsigned shard_count() const;
+
+private:
+    struct Shard
+    {
+        std::mutex mutex;
+        std::unique_ptr<BST<T>> tree {new BST<T>()};
+    };
+
+    // the smallest limit on a shard's size before a rebalance
+    // Without a sample all keys go to shard 0 until it holds this
+    // many, which then serve as the sample for the splitters.
+    static constexpr unsigned first_sample = 1024;
+
+    // the shard for k, the caller holds layout_mutex_
+    unsigned shard_of(const T& k) const;
+
+    // true if a shard of size keys calls for a rebalance
+    // The caller holds layout_mutex_.
+    bool skewed(unsigned size) const;
+
+    // rebalance with layout_mutex_ already held exclusively
+    void rebuild();
+
+    // inserts the sorted nodes from first to last median first, so
+    // that the tree comes out balanced
+    static void insert_balanced(BST<T>& tree, std::vector<typename BST<T>::Node_handle>& nodes,
+                                std::size_t first, std::size_t last);
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::vector<T> splitters_;
+    std::shared_mutex layout_mutex_;
+    // shards larger than this trigger a rebalance
+    std::atomic<unsigned> limit_ {first_sample};
+    // the number of keys at the last rebuild, under layout_mutex_
+    std::size_t rebuilt_size_ = 0;
+    // calls to insert since the last rebuild
+    // Every insert already writes the shared layout lock, so one more
+    // shared counter adds little contention.
+    std::atomic<std::size_t> inserts_ {0};
+};
+
+template <typename T>
+Sharded_BST<T>::Sharded_BST(unsigned shards, std::vector<T> sample)
+{
+    shards = std::max(shards, 1u);
+    for(unsigned i = 0; i < shards; ++i)
+    {
+        shards_.emplace_back(new Shard());
+    }
+    std::sort(sample.begin(), sample.end());
+    sample.erase(std::unique(sample.begin(), sample.end()), sample.end());
+    if(!sample.empty())
+    {
+        for(unsigned i = 1; i < shards; ++i)
+        {
+            splitters_.push_back(sample[sample.size() * i / shards]);
+        }
+    }
+}
+
+template <typename T>
+void Sharded_BST<T>::insert(T k)
+{
+    bool grown = false;
+    {
+        std::shared_lock<std::shared_mutex> layout(layout_mutex_);
+        Shard& shard = *shards_[shard_of(k)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.tree->insert(k);
+        inserts_.fetch_add(1, std::memory_order_relaxed);
+        grown = skewed(shard.tree->size());
+    }
+    if(grown)
+    {
+        std::unique_lock<std::shared_mutex> layout(layout_mutex_);
+        // another thread may have rebalanced in the meantime
+        for(auto& shard : shards_)
+        {
+            if(skewed(shard->tree->size()))
+            {
+                rebuild();
+                break;
+            }
+        }
+    }
+}
+
+template <typename T>
+bool Sharded_BST<T>::contains(T k)
+{
+    std::shared_lock<std::shared_mutex> layout(layout_mutex_);
+    Shard& shard = *shards_[shard_of(k)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.tree->find(k) != nullptr;
+}
+
+template <typename T>
+void Sharded_BST<T>::erase(T k)
+{
+    std::shared_lock<std::shared_mutex> layout(layout_mutex_);
+    Shard& shard = *shards_[shard_of(k)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.tree->erase(k);
+}
+
+template <typename T>
+unsigned Sharded_BST<T>::size()
+{
+    std::shared_lock<std::shared_mutex> layout(layout_mutex_);
+    unsigned total = 0;
+    for(auto& shard : shards_)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        total += shard->tree->size();
+    }
+    return total;
+}
+
+// every key of a shard is smaller than every key of the shards after
+// it, so the minimum is that of the first shard that is not empty
+template <typename T>
+bool Sharded_BST<T>::min(T& out)
+{
+    std::shared_lock<std::shared_mutex> layout(layout_mutex_);
+    for(auto& shard : shards_)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        if(shard->tree->min() != nullptr)
+        {
+            out = shard->tree->min()->key;
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename T>
+bool Sharded_BST<T>::delete_min(T& out)
+{
+    std::shared_lock<std::shared_mutex> layout(layout_mutex_);
+    for(auto& shard : shards_)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        if(shard->tree->pop_min(out))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// the successor lies in k's own shard unless k is its largest key,
+// and then it is the minimum of the next shard that is not empty
+template <typename T>
+bool Sharded_BST<T>::successor(T k, T& out)
+{
+    std::shared_lock<std::shared_mutex> layout(layout_mutex_);
+    unsigned i = shard_of(k);
+    {
+        Shard& shard = *shards_[i];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if(shard.tree->find(k) == nullptr)
+        {
+            return false;
+        }
+        typename BST<T>::Node* next = shard.tree->successor(k);
+        if(next != nullptr)
+        {
+            out = next->key;
+            return true;
+        }
+    }
+    for(++i; i < shards_.size(); ++i)
+    {
+        std::lock_guard<std::mutex> lock(shards_[i]->mutex);
+        if(shards_[i]->tree->min() != nullptr)
+        {
+            out = shards_[i]->tree->min()->key;
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename T>
+template <typename Fn>
+void Sharded_BST<T>::for_each(Fn fn)
+{
+    std::shared_lock<std::shared_mutex> layout(layout_mutex_);
+    for(auto& shard : shards_)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        for(const T& k : shard->tree->make_vec())
+        {
+            fn(k);
+        }
+    }
+}
+
+template <typename T>
+std::vector<T> Sharded_BST<T>::make_vec()
+{
+    std::vector<T> vec;
+    for_each([&vec](const T& k) { vec.push_back(k); });
+    return vec;
+}
+
+template <typename T>
+void Sharded_BST<T>::rebalance()
+{
+    std::unique_lock<std::shared_mutex> layout(layout_mutex_);
+    rebuild();
+}
+
+// The limit is twice the fair share of a shard, and insert rebuilds only
+// after as many inserts as there were keys at the last rebuild.  Counting
+// inserts rather than keys still repairs skew when erases keep the size
+// flat, and the O(n log n) rebuilds triggered by insert add up to
+// O(log n) per insert.
+template <typename T>
+void Sharded_BST<T>::rebuild()
+{
+    // the exclusive layout lock keeps every other operation out,
+    // so the shard mutexes are not needed
+    // The nodes are moved rather than copied, see BST::extract.
+    std::vector<typename BST<T>::Node_handle> nodes;
+    for(auto& shard : shards_)
+    {
+        while(shard->tree->min() != nullptr)
+        {
+            nodes.push_back(shard->tree->extract(shard->tree->min()));
+        }
+    }
+    const std::size_t n = shards_.size();
+    splitters_.clear();
+    for(std::size_t i = 1; i < n && !nodes.empty(); ++i)
+    {
+        splitters_.push_back(nodes[nodes.size() * i / n].key());
+    }
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        std::size_t lo = nodes.size() * i / n;
+        std::size_t hi = nodes.size() * (i + 1) / n;
+        insert_balanced(*shards_[i]->tree, nodes, lo, hi);
+    }
+    limit_.store(std::max<std::size_t>(first_sample, 2 * nodes.size() / n + 1));
+    rebuilt_size_ = nodes.size();
+    inserts_.store(0, std::memory_order_relaxed);
+}
+
+template <typename T>
+std::vector<unsigned> Sharded_BST<T>::shard_sizes()
+{
+    std::shared_lock<std::shared_mutex> layout(layout_mutex_);
+    std::vector<unsigned> sizes;
+    for(auto& shard : shards_)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        sizes.push_back(shard->tree->size());
+    }
+    return sizes;
+}
+
+template <typename T>
+unsigned Sharded_BST<T>::shard_count() const
+{
+    return shards_.size();
+}
+
+template <typename T>
+unsigned Sharded_BST<T>::shard_of(const T& k) const
+{
+    return std::upper_bound(splitters_.begin(), splitters_.end(), k) - splitters_.begin();
+}
+
+template <typename T>
+bool Sharded_BST<T>::skewed(unsigned size) const
+{
+    return shards_.size() > 1 && size > limit_.load(std::memory_order_relaxed) &&
+           inserts_.load(std::memory_order_relaxed) >= rebuilt_size_;
+}
+
+template <typename T>
+void Sharded_BST<T>::insert_balanced(BST<T>& tree, std::vector<typename BST<T>::Node_handle>& nodes,
+                                     std::size_t first, std::size_t last)
+{
+    // ranges still to insert, each by its median first
+    std::vector<std::pair<std::size_t, std::size_t>> pending {{first, last}};
+    while(!pending.empty())
+    {
+        std::pair<std::size_t, std::size_t> r = pending.back();
+        pending.pop_back();
+        if(r.first >= r.second)
+        {
+            continue;
+        }
+        std::size_t mid = r.first + (r.second - r.first) / 2;
+        tree.insert(std::move(nodes[mid]));
+        pending.push_back({r.first, mid});
+        pending.push_back({mid + 1, r.second});
+    }
+}
+
+#endif
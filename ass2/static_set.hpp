@@ -0,0 +1,170 @@
+#ifndef STATIC_SET_HPP
+#define STATIC_SET_HPP
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+// An ordered set of keys fixed when the program is built.
+// The keys are sorted and deduplicated by the constexpr constructor,
+// so a set declared constexpr costs nothing at startup and lives in
+// read-only data:
+//
+//     constexpr Static_set<int, 5> primes {{7, 2, 5, 3, 11}};
+//     static_assert(primes.find(5) != nullptr, "");
+//
+// The keys are kept in one flat array.  Lookups are a binary search
+// whose number of steps only depends on the capacity N, with each step
+// choosing the next half by a conditional move rather than a branch.
+// As N is a constant the compiler unrolls the search completely.
+// The queries mirror those of BST, but return pointers to keys rather
+// than to nodes.
+// T must be usable in constant expressions (a literal type) to build
+// the set at compile time; other types still work at run time.
+template <typename T, std::size_t N>
+class Static_set
+{
+private:
+    // keys_[0, size_) holds the distinct keys in increasing order.
+    // The remaining slots repeat the largest key so that the whole
+    // array stays sorted and the search never needs to know size_.
+    std::array<T, N> keys_ {};
+    std::size_t size_ = 0;
+
+public:
+    // Builds the set from any N keys, duplicates are dropped
+    constexpr explicit Static_set(const T (&keys)[N]);
+    constexpr explicit Static_set(const std::array<T, N>& keys);
+
+    // Returns a pointer to the key equal to k, nullptr if there is none
+    constexpr const T* find(const T& k) const;
+
+    // Returns a pointer to the smallest key larger than k
+    // Like BST, returns nullptr if k is the largest key or not in the set
+    constexpr const T* successor(const T& k) const;
+
+    // Returns a pointer to the smallest key, nullptr if the set is empty
+    constexpr const T* min() const;
+
+    constexpr unsigned size() const;
+
+    // The keys in increasing order
+    std::vector<T> make_vec() const;
+
+private:
+    // sorts keys_ and drops duplicates, setting size_
+    constexpr void build();
+
+    // index of the first slot whose key is not less than k, or N
+    constexpr std::size_t lower_bound(const T& k) const;
+};
+
+template <typename T, std::size_t N>
+constexpr Static_set<T, N>::Static_set(const T (&keys)[N])
+{
+    for(std::size_t i = 0; i < N; ++i)
+    {
+        keys_[i] = keys[i];
+    }
+    build();
+}
+
+template <typename T, std::size_t N>
+constexpr Static_set<T, N>::Static_set(const std::array<T, N>& keys)
+    : keys_(keys)
+{
+    build();
+}
+
+// Insertion sort, which is simple to evaluate at compile time and
+// fast enough for tables of a few thousand keys.  The cost is only
+// ever paid by the compiler for constexpr sets.
+template <typename T, std::size_t N>
+constexpr void Static_set<T, N>::build()
+{
+    for(std::size_t i = 1; i < N; ++i)
+    {
+        T key = keys_[i];
+        std::size_t j = i;
+        for(; j > 0 && key < keys_[j - 1]; --j)
+        {
+            keys_[j] = keys_[j - 1];
+        }
+        keys_[j] = key;
+    }
+    size_ = 0;
+    for(std::size_t i = 0; i < N; ++i)
+    {
+        if(size_ == 0 || keys_[size_ - 1] < keys_[i])
+        {
+            keys_[size_++] = keys_[i];
+        }
+    }
+    for(std::size_t i = size_; i < N; ++i)
+    {
+        keys_[i] = keys_[size_ - 1];
+    }
+}
+
+// Each step halves the range and moves base to the upper half if
+// its first element is still less than k.  The loop runs about
+// log2(N) times whatever k is, so there is nothing to predict.
+template <typename T, std::size_t N>
+constexpr std::size_t Static_set<T, N>::lower_bound(const T& k) const
+{
+    if(N == 0)
+    {
+        return 0;
+    }
+    std::size_t base = 0;
+    std::size_t n = N;
+    while(n > 1)
+    {
+        std::size_t half = n / 2;
+        base = (keys_[base + half] < k) ? base + half : base;
+        n -= half;
+    }
+    return base + (keys_[base] < k);
+}
+
+template <typename T, std::size_t N>
+constexpr const T* Static_set<T, N>::find(const T& k) const
+{
+    std::size_t i = lower_bound(k);
+    if(i >= size_ || k < keys_[i])
+    {
+        return nullptr;
+    }
+    return &keys_[i];
+}
+
+template <typename T, std::size_t N>
+constexpr const T* Static_set<T, N>::successor(const T& k) const
+{
+    std::size_t i = lower_bound(k);
+    if(i + 1 >= size_ || k < keys_[i])
+    {
+        return nullptr;
+    }
+    return &keys_[i + 1];
+}
+
+template <typename T, std::size_t N>
+constexpr const T* Static_set<T, N>::min() const
+{
+    return (size_ == 0) ? nullptr : &keys_[0];
+}
+
+template <typename T, std::size_t N>
+constexpr unsigned Static_set<T, N>::size() const
+{
+    return static_cast<unsigned>(size_);
+}
+
+template <typename T, std::size_t N>
+std::vector<T> Static_set<T, N>::make_vec() const
+{
+    return std::vector<T>(keys_.begin(), keys_.begin() + size_);
+}
+
+#endif
@@ -1,22 +1,61 @@
 #ifndef ASSERT_TESTS_HPP
 #define ASSERT_TESTS_HPP
 
+#include <algorithm>
 #include <unordered_set>
 #include <vector>
 #include <string>
 #include <cassert>
 #include <random>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <set>
+#include <iterator>
+#include <atomic>
+#include <thread>
 #include "bst.hpp"
+#include "persistent_bst.hpp"
+#include "rcu_bst.hpp"
+#include "sharded_bst.hpp"
+#include "static_set.hpp"
+#include "../common/workload.hpp"
+#include "../common/complexity.hpp"
+
+// A key type that can be ordered but has no std::hash, for checking
+// that the containers only need the hash when the filter is on
+struct Unhashable_key
+{
+    int value;
+    bool operator<(const Unhashable_key& other) const { return value < other.value; }
+    bool operator>(const Unhashable_key& other) const { return value > other.value; }
+    bool operator==(const Unhashable_key& other) const { return value == other.value; }
+    bool operator!=(const Unhashable_key& other) const { return value != other.value; }
+};
 
 class Tester
 {
+private:
+    // Every random choice comes from mt_, so a failing run can be
+    // repeated by constructing the Tester with the seed it printed
+    std::uint64_t seed_;
+    std::mt19937 mt_;
+
 public:
+    explicit Tester(std::uint64_t seed = std::random_device()())
+        : seed_(seed), mt_(seed)
+    {
+    }
+
+    std::uint64_t seed() const
+    {
+        return seed_;
+    }
+
     std::vector<int> generate_without_duplicates()
     {
-        std::random_device rd;
-        std::mt19937 mt(rd());
         std::uniform_int_distribution<unsigned> size_dist(2,20);
-        unsigned size = size_dist(mt);
+        unsigned size = size_dist(mt_);
         std::vector<int> vec;
         vec.reserve(size);
         std::unordered_set<int> setto;
@@ -24,7 +63,7 @@ public:
         unsigned i = 0;
         while(i < size)
         {
-            int val = val_dist(mt);
+            int val = val_dist(mt_);
             if(setto.count(val) == 0)
             {
                 setto.insert(val);
@@ -61,12 +100,10 @@ public:
             tree.insert(x);
         }
         assert(vec.size() == tree.size());
-        std::random_device rd;
-        std::mt19937 mt(rd());
         std::uniform_int_distribution<unsigned> index_dist(0,vec.size()-1);
         for(int i = 0; i < 5; ++i)
         {
-            unsigned index = index_dist(mt);
+            unsigned index = index_dist(mt_);
             tree.insert(vec[index]);
             assert(vec.size() == tree.size());
         }
@@ -148,12 +185,10 @@ public:
             tree.insert(x);
         }
         std::sort(vec.begin(), vec.end());
-        std::random_device rd;
-        std::mt19937 mt(rd());
         std::uniform_int_distribution<unsigned> index_dist(0,vec.size()-2);
         for(int i = 0; i < 3; ++i)
         {
-            unsigned index = index_dist(mt);
+            unsigned index = index_dist(mt_);
             BST<int>::Node* node = tree.successor(vec[index]);
             assert(node != nullptr);
             assert(node->key == vec[index+1]);
@@ -185,10 +220,8 @@ public:
             tree.insert(x);
         }
         std::sort(vec.begin(), vec.end());
-        std::random_device rd;
-        std::mt19937 mt(rd());
         std::uniform_int_distribution<unsigned> index_dist(0,vec.size()-1);
-        unsigned index = index_dist(mt);
+        unsigned index = index_dist(mt_);
         tree.erase(vec[index]);
         vec.erase(vec.begin()+index);
         std::sort(vec.begin(), vec.end());
@@ -207,10 +240,8 @@ public:
             tree.insert(x);
         }
         std::sort(vec.begin(), vec.end());
-        std::random_device rd;
-        std::mt19937 mt(rd());
         std::uniform_int_distribution<unsigned> index_dist(0,vec.size()-1);
-        unsigned index = index_dist(mt);
+        unsigned index = index_dist(mt_);
         tree.erase(vec[index]);
         std::vector<int> your_heights = tree.your_postorder_heights(); 
         std::vector<int> real_heights = tree.real_postorder_heights(); 
@@ -266,10 +297,8 @@ public:
         {
             tree.insert(x);
         }
-        std::random_device rd;
-        std::mt19937 mt(rd());
         std::uniform_int_distribution<unsigned> index_dist(0,vec.size()-1);
-        unsigned index = index_dist(mt);
+        unsigned index = index_dist(mt_);
         BST<int>::Node* node = tree.find(vec[index]);
         assert(node != nullptr);
         if(node->left == nullptr)
@@ -325,10 +354,8 @@ public:
         {
             tree.insert(x);
         }
-        std::random_device rd;
-        std::mt19937 mt(rd());
         std::uniform_int_distribution<unsigned> index_dist(0,vec.size()-1);
-        unsigned index = index_dist(mt);
+        unsigned index = index_dist(mt_);
         BST<int>::Node* node = tree.find(vec[index]);
         assert(node != nullptr);
         if(node->left == nullptr)
@@ -342,6 +369,1498 @@ public:
         assert(your_heights == real_heights);
         std::cout << "passed test_rotate_heights\n";
     }
+
+    void test_rotate_left(void)
+    {
+        std::vector<int> vec = generate_without_duplicates();
+        BST<int> tree;
+        for(int x : vec)
+        {
+            tree.insert(x);
+        }
+        std::uniform_int_distribution<unsigned> index_dist(0,vec.size()-1);
+        unsigned index = index_dist(mt_);
+        BST<int>::Node* node = tree.find(vec[index]);
+        assert(node != nullptr);
+        if(node->right == nullptr)
+        {
+            return;
+        }
+        BST<int>::Node* right_child = node->right;
+        BST<int>::Node* original_parent = node->parent;
+        tree.rotate_left(node);
+        assert(right_child->left == node);  
+        assert(right_child == node->parent);  
+        assert(right_child->parent == original_parent);  
+        std::sort(vec.begin(), vec.end());
+        assert(tree.make_vec() == vec); 
+        assert(tree.your_postorder_heights() == tree.real_postorder_heights());
+        std::cout << "passed test_rotate_left\n";
+    }
+
+    // Random operations on a tree in splay mode compared with std::set.
+    // Every access must leave the key it reached at the root and
+    // every height correct.
+    void test_splay(void)
+    {
+        BST<int> tree;
+        tree.set_splay(true);
+        assert(tree.splay());
+        std::set<int> real;
+        std::uniform_int_distribution<int> val_dist(0, 60);
+        std::uniform_int_distribution<int> op_dist(0, 4);
+        for(int i = 0; i < 300; ++i)
+        {
+            int k = val_dist(mt_);
+            switch(op_dist(mt_))
+            {
+                case 0:
+                case 1:
+                    tree.insert(k);
+                    real.insert(k);
+                    assert(tree.get_root_value() == k);
+                    break;
+                case 2:
+                {
+                    bool present = real.count(k) != 0;
+                    assert((tree.find(k) != nullptr) == present);
+                    if(present)
+                    {
+                        assert(tree.get_root_value() == k);
+                    }
+                    break;
+                }
+                case 3:
+                {
+                    BST<int>::Node* next = tree.successor(k);
+                    auto real_next = real.upper_bound(k);
+                    if(real.count(k) == 0 || real_next == real.end())
+                    {
+                        assert(next == nullptr);
+                    }
+                    else
+                    {
+                        assert(next != nullptr && next->key == *real_next);
+                    }
+                    break;
+                }
+                default:
+                    tree.erase(k);
+                    real.erase(k);
+                    break;
+            }
+            assert(tree.size() == real.size());
+            assert(tree.make_vec() == std::vector<int>(real.begin(), real.end()));
+            assert(tree.your_postorder_heights() == tree.real_postorder_heights());
+        }
+        while(tree.size() > 0)
+        {
+            tree.delete_min();
+            assert(tree.your_postorder_heights() == tree.real_postorder_heights());
+        }
+        std::cout << "passed test_splay\n";
+    }
+
+    // Finds and successor scans with the finger cache on, mixed
+    // with erases that must make the tree forget the finger
+    void test_finger(void)
+    {
+        BST<int> tree;
+        tree.set_finger(true);
+        assert(tree.finger());
+        std::set<int> real;
+        std::uniform_int_distribution<int> val_dist(0, 200);
+        for(int i = 0; i < 150; ++i)
+        {
+            int k = val_dist(mt_);
+            tree.insert(k);
+            real.insert(k);
+        }
+        for(int round = 0; round < 20; ++round)
+        {
+            // a full in-order scan by successor
+            std::vector<int> scanned;
+            for(BST<int>::Node* node = tree.min(); node != nullptr; node = tree.successor(node->key))
+            {
+                scanned.push_back(node->key);
+            }
+            assert(scanned == std::vector<int>(real.begin(), real.end()));
+            // lookups near each other, hits and misses
+            int centre = val_dist(mt_);
+            for(int k = centre - 10; k < centre + 10; ++k)
+            {
+                BST<int>::Node* node = tree.find(k);
+                assert((node != nullptr) == (real.count(k) != 0));
+                assert(node == nullptr || node->key == k);
+            }
+            int k = val_dist(mt_);
+            tree.erase(k);
+            real.erase(k);
+            tree.delete_min();
+            if(!real.empty())
+            {
+                real.erase(real.begin());
+            }
+            assert(tree.size() == real.size());
+        }
+        std::cout << "passed test_finger\n";
+    }
+
+    // The filter must never hide a key of the tree, and should turn
+    // away most lookups for absent keys as keys come and go
+    void test_filter(void)
+    {
+        BST<int> tree;
+        std::set<int> real;
+        std::uniform_int_distribution<int> val_dist(0, 1 << 20);
+        for(int i = 0; i < 500; ++i)
+        {
+            int k = val_dist(mt_);
+            tree.insert(k);
+            real.insert(k);
+        }
+        tree.set_filter(0.01);
+        // misses and false positives of the random lookups alone, as
+        // lookups of just erased keys are expected false positives
+        std::uint64_t misses = 0;
+        std::uint64_t false_positives = 0;
+        for(int round = 0; round < 4; ++round)
+        {
+            Filter_stats before = tree.filter_stats();
+            for(int i = 0; i < 2000; ++i)
+            {
+                int k = val_dist(mt_);
+                assert((tree.find(k) != nullptr) == (real.count(k) != 0));
+                misses += (real.count(k) == 0);
+            }
+            false_positives += tree.filter_stats().false_positives - before.false_positives;
+            for(int k : real)
+            {
+                assert(tree.find(k) != nullptr);
+            }
+            // grow past the capacity, then erase most of the keys
+            for(int i = 0; i < 1000; ++i)
+            {
+                int k = val_dist(mt_);
+                tree.insert(k);
+                real.insert(k);
+            }
+            while(real.size() > 300)
+            {
+                int k = *real.begin();
+                tree.delete_min();
+                real.erase(real.begin());
+                assert(tree.find(k) == nullptr);
+                k = *std::prev(real.end());
+                tree.erase(k);
+                real.erase(k);
+            }
+        }
+        Filter_stats stats = tree.filter_stats();
+        assert(stats.lookups > 0 && stats.rebuilds > 0);
+        assert(stats.hit_rate() > 0.5);
+        assert(false_positives < misses / 20);
+        tree.set_filter(0);
+        assert(tree.filter_stats().lookups == 0);
+        std::cout << "passed test_filter\n";
+    }
+
+    // Keys without std::hash work as long as the filter is off
+    void test_unhashable_key(void)
+    {
+        static_assert(!Is_filter_hashable<Unhashable_key>::value, "the test key must not be hashable");
+        BST<Unhashable_key> tree;
+        Sharded_BST<Unhashable_key> sharded(4);
+        std::set<int> real;
+        std::uniform_int_distribution<int> val_dist(0, 200);
+        for(int i = 0; i < 300; ++i)
+        {
+            Unhashable_key k {val_dist(mt_)};
+            if(i % 3 == 2)
+            {
+                tree.erase(k);
+                sharded.erase(k);
+                real.erase(k.value);
+            }
+            else
+            {
+                tree.insert(k);
+                sharded.insert(k);
+                real.insert(k.value);
+            }
+        }
+        std::vector<int> values;
+        for(const Unhashable_key& k : tree.make_vec())
+        {
+            values.push_back(k.value);
+        }
+        assert(values == std::vector<int>(real.begin(), real.end()));
+        assert(sharded.size() == real.size());
+        for(int x : real)
+        {
+            assert(tree.find(Unhashable_key {x}) != nullptr);
+            assert(sharded.contains(Unhashable_key {x}));
+        }
+        std::cout << "passed test_unhashable_key\n";
+    }
+
+    // The tree as a priority queue: the cached min and max must follow
+    // every kind of update, and pop_min_n must cut off exactly the
+    // smallest keys with correct heights left behind
+    void test_priority_queue(void)
+    {
+        BST<int> tree;
+        std::set<int> real;
+        std::uniform_int_distribution<int> val_dist(0, 500);
+        std::uniform_int_distribution<int> op_dist(0, 5);
+        for(int i = 0; i < 600; ++i)
+        {
+            switch(op_dist(mt_))
+            {
+                case 0:
+                case 1:
+                case 2:
+                {
+                    int k = val_dist(mt_);
+                    tree.insert(k);
+                    real.insert(k);
+                    break;
+                }
+                case 3:
+                {
+                    int k = val_dist(mt_);
+                    tree.erase(k);
+                    real.erase(k);
+                    break;
+                }
+                case 4:
+                {
+                    int k = 0;
+                    assert(tree.pop_min(k) == !real.empty());
+                    if(!real.empty())
+                    {
+                        assert(k == *real.begin());
+                        real.erase(real.begin());
+                    }
+                    break;
+                }
+                default:
+                {
+                    unsigned n = std::uniform_int_distribution<unsigned>(0, 12)(mt_);
+                    std::vector<int> popped;
+                    unsigned removed = tree.pop_min_n(n, popped);
+                    assert(removed == std::min<std::size_t>(n, real.size()));
+                    assert(popped.size() == removed);
+                    for(int k : popped)
+                    {
+                        assert(k == *real.begin());
+                        real.erase(real.begin());
+                    }
+                    break;
+                }
+            }
+            assert(tree.size() == real.size());
+            if(real.empty())
+            {
+                assert(tree.min() == nullptr && tree.max() == nullptr);
+            }
+            else
+            {
+                assert(tree.min()->key == *real.begin());
+                assert(tree.max()->key == *real.rbegin());
+            }
+            assert(tree.your_postorder_heights() == tree.real_postorder_heights());
+        }
+        assert(tree.make_vec() == std::vector<int>(real.begin(), real.end()));
+        std::cout << "passed test_priority_queue\n";
+    }
+
+    // Multiset mode against std::multiset, from a small key range so
+    // that most keys have several copies, with and without splaying
+    void test_multiset(void)
+    {
+        BST<int> tree;
+        tree.set_multiset(true);
+        tree.set_splay(std::uniform_int_distribution<int>(0, 1)(mt_) == 1);
+        std::multiset<int> real;
+        std::uniform_int_distribution<int> val_dist(0, 40);
+        std::uniform_int_distribution<int> op_dist(0, 7);
+        for(int i = 0; i < 800; ++i)
+        {
+            int k = val_dist(mt_);
+            switch(op_dist(mt_))
+            {
+                case 0:
+                case 1:
+                case 2:
+                    tree.insert(k);
+                    real.insert(k);
+                    break;
+                case 3:
+                {
+                    bool present = real.find(k) != real.end();
+                    assert(tree.erase_one(k) == present);
+                    if(present)
+                    {
+                        real.erase(real.find(k));
+                    }
+                    break;
+                }
+                case 4:
+                    assert(tree.erase_all(k) == real.erase(k));
+                    break;
+                case 5:
+                {
+                    int out = 0;
+                    assert(tree.pop_min(out) == !real.empty());
+                    if(!real.empty())
+                    {
+                        assert(out == *real.begin());
+                        real.erase(real.begin());
+                    }
+                    break;
+                }
+                case 6:
+                {
+                    unsigned n = std::uniform_int_distribution<unsigned>(0, 12)(mt_);
+                    std::vector<int> popped;
+                    unsigned removed = tree.pop_min_n(n, popped);
+                    assert(removed == std::min<std::size_t>(n, real.size()));
+                    assert(popped.size() == removed);
+                    for(int x : popped)
+                    {
+                        assert(x == *real.begin());
+                        real.erase(real.begin());
+                    }
+                    break;
+                }
+                default:
+                {
+                    assert(tree.count(k) == real.count(k));
+                    auto next = real.upper_bound(k);
+                    typename BST<int>::Node* succ = tree.successor(k);
+                    if(real.count(k) == 0 || next == real.end())
+                    {
+                        assert(succ == nullptr);
+                    }
+                    else
+                    {
+                        assert(succ != nullptr && succ->key == *next);
+                    }
+                    break;
+                }
+            }
+            std::set<int> distinct(real.begin(), real.end());
+            assert(tree.size() == real.size());
+            assert(tree.distinct_size() == distinct.size());
+            assert(tree.make_vec() == std::vector<int>(distinct.begin(), distinct.end()));
+            assert(tree.your_postorder_heights() == tree.real_postorder_heights());
+        }
+        assert(tree.make_vec(true) == std::vector<int>(real.begin(), real.end()));
+
+        // with the mode off a present key is left alone, but the
+        // copies counted so far stay
+        tree.set_multiset(false);
+        if(!real.empty())
+        {
+            int k = *real.begin();
+            tree.insert(k);
+            assert(tree.count(k) == real.count(k));
+        }
+        assert(tree.size() == real.size());
+        std::cout << "passed test_multiset\n";
+    }
+
+    // Hinted insertion against std::set, with hints that are next to
+    // the new key, far from it and nullptr, and insert_back on an
+    // increasing stream without visiting any node
+    void test_hinted_insert(void)
+    {
+        BST<int> tree;
+        tree.set_splay(std::uniform_int_distribution<int>(0, 1)(mt_) == 1);
+        std::set<int> real;
+        std::uniform_int_distribution<int> val_dist(0, 2000);
+        std::uniform_int_distribution<int> hint_dist(0, 3);
+        BST<int>::Node* last = nullptr;
+        for(int i = 0; i < 600; ++i)
+        {
+            int k = val_dist(mt_);
+            BST<int>::Node* hint = nullptr;
+            switch(hint_dist(mt_))
+            {
+                case 0:
+                    hint = last;
+                    break;
+                case 1:
+                    hint = tree.min();
+                    break;
+                case 2:
+                    hint = tree.max();
+                    break;
+                default:
+                    break;
+            }
+            last = tree.insert(hint, k);
+            real.insert(k);
+            assert(last != nullptr && last->key == k);
+            assert(tree.size() == real.size());
+            assert(tree.min()->key == *real.begin());
+            assert(tree.max()->key == *real.rbegin());
+            assert(tree.your_postorder_heights() == tree.real_postorder_heights());
+        }
+        assert(tree.make_vec() == std::vector<int>(real.begin(), real.end()));
+
+        // every key next to the one before, and repeats in multiset mode
+        BST<int, Count_stats> stream;
+        stream.set_multiset(true);
+        std::vector<int> keys;
+        BST<int, Count_stats>::Node* hint = nullptr;
+        for(int k = 0; k < 500; ++k)
+        {
+            hint = stream.insert_back(2 * k);
+            keys.push_back(2 * k);
+            if(k % 7 == 0)
+            {
+                assert(stream.insert(hint, 2 * k) == hint);
+                keys.push_back(2 * k);
+            }
+            // one step back, next to the previous key
+            if(k % 5 == 1)
+            {
+                hint = stream.insert(hint, 2 * k - 1);
+                keys.push_back(2 * k - 1);
+            }
+        }
+        std::sort(keys.begin(), keys.end());
+        assert(stream.stats().nodes_visited == 0);
+        assert(stream.make_vec(true) == keys);
+        assert(stream.size() == keys.size());
+        assert(stream.your_postorder_heights() == stream.real_postorder_heights());
+        std::cout << "passed test_hinted_insert\n";
+    }
+
+    // extract and insert of node handles and merge against std::set,
+    // checking that nodes move between trees without being allocated
+    // again and that erase leaves the other nodes where they were
+    void test_extract_merge(void)
+    {
+        BST<int, Count_stats> a;
+        BST<int, Count_stats> b;
+        bool splay = std::uniform_int_distribution<int>(0, 1)(mt_) == 1;
+        a.set_splay(splay);
+        b.set_splay(!splay);
+        std::set<int> real_a;
+        std::set<int> real_b;
+        std::uniform_int_distribution<int> val_dist(0, 400);
+        for(int i = 0; i < 300; ++i)
+        {
+            int k = val_dist(mt_);
+            a.insert(k);
+            real_a.insert(k);
+            k = val_dist(mt_);
+            b.insert(k);
+            real_b.insert(k);
+        }
+
+        // erase only frees the node of its key
+        int kept = *real_a.rbegin();
+        BST<int, Count_stats>::Node* kept_node = a.find(kept);
+        for(int i = 0; i < 50; ++i)
+        {
+            int k = val_dist(mt_);
+            if(k != kept)
+            {
+                a.erase(k);
+                real_a.erase(k);
+            }
+        }
+        assert(a.find(kept) == kept_node);
+        assert(a.your_postorder_heights() == a.real_postorder_heights());
+
+        a.reset_stats();
+        b.reset_stats();
+        for(int i = 0; i < 200; ++i)
+        {
+            int k = val_dist(mt_);
+            BST<int, Count_stats>::Node* node = a.find(k);
+            BST<int, Count_stats>::Node_handle handle = a.extract(k);
+            assert(handle.empty() == (real_a.count(k) == 0));
+            if(handle.empty())
+            {
+                continue;
+            }
+            real_a.erase(k);
+            assert(handle.key() == k && handle.count() == 1);
+            bool present = real_b.count(k) == 1;
+            BST<int, Count_stats>::Node* position = b.insert(std::move(handle));
+            assert(position != nullptr && position->key == k);
+            assert(handle.empty() != present);
+            assert((position == node) != present);
+            real_b.insert(k);
+            assert(a.make_vec() == std::vector<int>(real_a.begin(), real_a.end()));
+            assert(b.make_vec() == std::vector<int>(real_b.begin(), real_b.end()));
+            assert(a.your_postorder_heights() == a.real_postorder_heights());
+            assert(b.your_postorder_heights() == b.real_postorder_heights());
+        }
+        assert(a.stats().allocations == 0 && b.stats().allocations == 0);
+        if(!real_a.empty())
+        {
+            assert(a.min()->key == *real_a.begin() && a.max()->key == *real_a.rbegin());
+        }
+
+        // a key changed in the handle, and an empty handle
+        if(!real_b.empty())
+        {
+            BST<int, Count_stats>::Node_handle handle = b.extract(b.min());
+            real_b.erase(real_b.begin());
+            handle.key() = 1000;
+            assert(a.insert(std::move(handle))->key == 1000);
+            real_a.insert(1000);
+        }
+        assert(b.insert(BST<int, Count_stats>::Node_handle()) == nullptr);
+
+        std::set<int> left_in_b;
+        std::set_intersection(real_b.begin(), real_b.end(), real_a.begin(), real_a.end(),
+                              std::inserter(left_in_b, left_in_b.end()));
+        unsigned expected = real_b.size() - left_in_b.size();
+        real_a.insert(real_b.begin(), real_b.end());
+        a.reset_stats();
+        assert(a.merge(b) == expected);
+        assert(a.stats().allocations == 0 && b.stats().frees == 0);
+        assert(a.make_vec() == std::vector<int>(real_a.begin(), real_a.end()));
+        assert(b.make_vec() == std::vector<int>(left_in_b.begin(), left_in_b.end()));
+        assert(a.size() == real_a.size() && b.size() == left_in_b.size());
+        assert(a.your_postorder_heights() == a.real_postorder_heights());
+        assert(b.your_postorder_heights() == b.real_postorder_heights());
+        assert(a.merge(a) == 0);
+
+        // in multiset mode every copy moves
+        BST<int> c;
+        BST<int> d;
+        c.set_multiset(true);
+        std::multiset<int> real_c;
+        for(int i = 0; i < 100; ++i)
+        {
+            int k = val_dist(mt_) % 20;
+            c.insert(k);
+            real_c.insert(k);
+            d.insert(val_dist(mt_) % 40);
+        }
+        std::vector<int> from_d = d.make_vec();
+        real_c.insert(from_d.begin(), from_d.end());
+        std::size_t moved = d.size();
+        assert(c.merge(d) == moved);
+        assert(d.size() == 0 && d.min() == nullptr);
+        assert(c.make_vec(true) == std::vector<int>(real_c.begin(), real_c.end()));
+        assert(c.your_postorder_heights() == c.real_postorder_heights());
+        std::cout << "passed test_extract_merge\n";
+    }
+
+    // erase_range, erase_below and erase_above against std::multiset,
+    // and freeing a chain far deeper than recursion would allow
+    void test_erase_range(void)
+    {
+        BST<int, Count_stats> tree;
+        tree.set_multiset(true);
+        tree.set_splay(std::uniform_int_distribution<int>(0, 1)(mt_) == 1);
+        std::multiset<int> real;
+        std::uniform_int_distribution<int> val_dist(0, 1000);
+        std::uniform_int_distribution<int> op_dist(0, 9);
+        for(int i = 0; i < 600; ++i)
+        {
+            int a = val_dist(mt_);
+            int b = val_dist(mt_);
+            unsigned removed = 0;
+            std::size_t expected = 0;
+            switch(op_dist(mt_))
+            {
+                case 0:
+                    removed = tree.erase_range(a, b);
+                    if(a < b)
+                    {
+                        expected = std::distance(real.lower_bound(a), real.lower_bound(b));
+                        real.erase(real.lower_bound(a), real.lower_bound(b));
+                    }
+                    break;
+                case 1:
+                    // narrow ranges, most of them inside the tree
+                    removed = tree.erase_range(a, a + 20);
+                    expected = std::distance(real.lower_bound(a), real.lower_bound(a + 20));
+                    real.erase(real.lower_bound(a), real.lower_bound(a + 20));
+                    break;
+                case 2:
+                    removed = tree.erase_below(a / 20);
+                    expected = std::distance(real.begin(), real.lower_bound(a / 20));
+                    real.erase(real.begin(), real.lower_bound(a / 20));
+                    break;
+                case 3:
+                    removed = tree.erase_above(1000 - a / 20);
+                    expected = std::distance(real.upper_bound(1000 - a / 20), real.end());
+                    real.erase(real.upper_bound(1000 - a / 20), real.end());
+                    break;
+                default:
+                    for(int j = 0; j < 4; ++j)
+                    {
+                        int k = val_dist(mt_);
+                        tree.insert(k);
+                        real.insert(k);
+                    }
+                    break;
+            }
+            assert(removed == expected);
+            assert(tree.size() == real.size());
+            assert(tree.make_vec(true) == std::vector<int>(real.begin(), real.end()));
+            assert(tree.your_postorder_heights() == tree.real_postorder_heights());
+            if(real.empty())
+            {
+                assert(tree.min() == nullptr && tree.max() == nullptr);
+            }
+            else
+            {
+                assert(tree.min()->key == *real.begin());
+                assert(tree.max()->key == *real.rbegin());
+            }
+        }
+        tree.reset_stats();
+        unsigned nodes = tree.distinct_size();
+        assert(tree.erase_range(-1, 2000) == real.size());
+        assert(tree.size() == 0 && tree.min() == nullptr && tree.max() == nullptr);
+        assert(tree.stats().frees == nodes);
+
+        // splaying an increasing stream leaves a chain of left children
+        BST<int> chain;
+        chain.set_splay(true);
+        const int n = 200000;
+        for(int k = 0; k < n; ++k)
+        {
+            chain.insert_back(k);
+        }
+        assert(chain.erase_below(n / 2) == unsigned(n / 2));
+        assert(chain.erase_above(n - 11) == 10u);
+        assert(chain.min()->key == n / 2 && chain.max()->key == n - 11);
+        assert(chain.size() == unsigned(n / 2 - 10));
+        std::cout << "passed test_erase_range\n";
+    }
+
+#ifdef DSA_HAS_GENERATOR
+    // The lazy traversals against make_vec and std::set, the stages
+    // built on them, and that a pipeline stops walking the tree as soon
+    // as it has what it needs
+    void test_generators(void)
+    {
+        BST<int, Count_stats> tree;
+        BST<int> other;
+        std::set<int> real;
+        std::uniform_int_distribution<int> val_dist(0, 1000);
+        for(int i = 0; i < 300; ++i)
+        {
+            int k = val_dist(mt_);
+            tree.insert(k);
+            real.insert(k);
+            other.insert(val_dist(mt_));
+        }
+
+        std::vector<int> keys;
+        for(int k : tree.in_order())
+        {
+            keys.push_back(k);
+        }
+        assert(keys == tree.make_vec());
+        std::vector<int> reversed;
+        for(int k : tree.reverse_order())
+        {
+            reversed.push_back(k);
+        }
+        assert(std::equal(reversed.begin(), reversed.end(), keys.rbegin(), keys.rend()));
+
+        for(int i = 0; i < 50; ++i)
+        {
+            int lo = val_dist(mt_);
+            int hi = val_dist(mt_);
+            std::vector<int> in_range;
+            for(int k : tree.range(lo, hi))
+            {
+                in_range.push_back(k);
+            }
+            std::vector<int> expected;
+            if(lo < hi)
+            {
+                expected.assign(real.lower_bound(lo), real.lower_bound(hi));
+            }
+            assert(in_range == expected);
+        }
+
+        // the first ten odd keys, doubled
+        std::vector<int> piped;
+        for(int k : taken(mapped(filtered(tree.in_order(), [](int k){ return k % 2 != 0; }),
+                                 [](int k){ return 2 * k; }), 10))
+        {
+            piped.push_back(k);
+        }
+        std::vector<int> expected;
+        for(int k : real)
+        {
+            if(k % 2 != 0 && expected.size() < 10)
+            {
+                expected.push_back(2 * k);
+            }
+        }
+        assert(piped == expected);
+
+        std::vector<Generator<int>> sources;
+        sources.push_back(tree.in_order());
+        sources.push_back(other.in_order());
+        sources.push_back(Generator<int>());
+        std::vector<int> together;
+        for(int k : merged(std::move(sources)))
+        {
+            together.push_back(k);
+        }
+        std::vector<int> other_keys = other.make_vec();
+        expected.clear();
+        std::merge(keys.begin(), keys.end(), other_keys.begin(), other_keys.end(), std::back_inserter(expected));
+        assert(together == expected);
+
+        // taking five keys visits five nodes, not the whole tree
+        tree.reset_stats();
+        std::size_t count = 0;
+        for(int k : taken(tree.in_order(), 5))
+        {
+            assert(k == keys[count]);
+            ++count;
+        }
+        assert(count == 5);
+        assert(tree.stats().nodes_visited == 5);
+        std::cout << "passed test_generators\n";
+    }
+#endif
+
+//*** 2 tests of Persistent_BST
+    void test_persistent_snapshot(void)
+    {
+        std::vector<int> vec = generate_without_duplicates();
+        Persistent_BST<int> tree;
+        for(int x : vec)
+        {
+            tree.insert(x);
+        }
+        Persistent_BST<int>::Snapshot before = tree.snapshot();
+        // later versions must not show through the old snapshot
+        tree.insert(-1);
+        tree.erase(vec[0]);
+        Persistent_BST<int>::Snapshot after = tree.snapshot();
+        std::sort(vec.begin(), vec.end());
+        assert(before.make_vec() == vec);
+        assert(before.size() == vec.size());
+        assert(before.find(-1) == nullptr);
+        assert(after.find(-1) != nullptr);
+        assert(after.size() == vec.size());
+        std::cout << "passed test_persistent_snapshot\n";
+    }
+
+    void test_persistent_erase(void)
+    {
+        std::vector<int> vec = generate_without_duplicates();
+        Persistent_BST<int> tree;
+        for(int x : vec)
+        {
+            tree.insert(x);
+        }
+        std::vector<Persistent_BST<int>::Snapshot> versions;
+        std::vector<std::vector<int>> expected;
+        std::vector<int> sorted_vec = vec;
+        std::sort(sorted_vec.begin(), sorted_vec.end());
+        for(int x : vec)
+        {
+            versions.push_back(tree.snapshot());
+            expected.push_back(sorted_vec);
+            tree.erase(x);
+            sorted_vec.erase(std::find(sorted_vec.begin(), sorted_vec.end(), x));
+        }
+        assert(tree.size() == 0);
+        for(unsigned i = 0; i < versions.size(); ++i)
+        {
+            assert(versions[i].make_vec() == expected[i]);
+            const Persistent_BST<int>::Node* node = versions[i].min();
+            assert(node != nullptr);
+            assert(node->key == expected[i].front());
+            if(expected[i].size() > 1)
+            {
+                node = versions[i].successor(expected[i][0]);
+                assert(node != nullptr && node->key == expected[i][1]);
+            }
+        }
+        std::cout << "passed test_persistent_erase\n";
+    }
+
+//*** 2 tests of Rcu_BST
+    // every read of a single thread against std::set, and a reader
+    // that stays in a read keeps old nodes from being freed
+    void test_rcu(void)
+    {
+        Rcu_BST<int> tree(4);
+        Rcu_BST<int>::Reader reader(tree);
+        assert(reader.valid());
+        std::set<int> real;
+        std::uniform_int_distribution<int> val_dist(0, 200);
+        for(int i = 0; i < 1000; ++i)
+        {
+            int k = val_dist(mt_);
+            if(i % 3 == 0)
+            {
+                tree.erase(k);
+                real.erase(k);
+            }
+            else
+            {
+                tree.insert(k);
+                real.insert(k);
+            }
+            assert(reader.contains(k) == (real.count(k) == 1));
+            int next = -1;
+            auto it = real.upper_bound(k);
+            assert(reader.successor(k, next) == (it != real.end()));
+            assert(it == real.end() || next == *it);
+        }
+        assert(reader.size() == real.size());
+        assert(reader.make_vec() == std::vector<int>(real.begin(), real.end()));
+        std::vector<int> in_range;
+        unsigned count = reader.range(50, 150, [&](int k){ in_range.push_back(k); });
+        assert(count == in_range.size());
+        assert(in_range == std::vector<int>(real.lower_bound(50), real.lower_bound(150)));
+
+        // with no read running everything retired has been freed
+        assert(tree.pending() == 0);
+        // a read in progress holds back the nodes retired meanwhile
+        bool wrote = false;
+        reader.range(0, 1000, [&](int)
+        {
+            if(!wrote)
+            {
+                tree.insert(1000);
+                tree.erase(1000);
+                assert(tree.pending() > 0);
+                wrote = true;
+            }
+        });
+        assert(wrote);
+        tree.synchronize();
+        assert(tree.pending() == 0);
+
+        // slots run out after max_readers readers
+        Rcu_BST<int>::Reader r2(tree), r3(tree), r4(tree), r5(tree);
+        assert(r4.valid() && !r5.valid());
+        assert(!r5.contains(*real.begin()));
+        std::cout << "passed test_rcu\n";
+    }
+
+    // a writer changes the tree while readers check that every version
+    // they see is sorted and holds the keys that are never erased
+    // Run under AddressSanitizer this also catches nodes freed too early.
+    void test_rcu_concurrent(void)
+    {
+        Rcu_BST<int> tree;
+        // even keys stay, odd keys come and go
+        for(int k = 0; k < 200; k += 2)
+        {
+            tree.insert(k);
+        }
+        std::atomic<bool> done {false};
+        std::atomic<unsigned> reads {0};
+        auto read = [&]()
+        {
+            Rcu_BST<int>::Reader reader(tree);
+            assert(reader.valid());
+            unsigned local = 0;
+            while(!done.load(std::memory_order_relaxed) || local < 100)
+            {
+                int k = 2 * (local % 100);
+                assert(reader.contains(k));
+                int prev = -1;
+                unsigned evens = 0;
+                reader.range(0, 200, [&](int x)
+                {
+                    assert(prev < x);
+                    prev = x;
+                    evens += (x % 2 == 0);
+                });
+                assert(evens == 100);
+                ++local;
+            }
+            reads.fetch_add(local);
+        };
+        std::vector<std::thread> readers;
+        for(int i = 0; i < 3; ++i)
+        {
+            readers.emplace_back(read);
+        }
+        std::uniform_int_distribution<int> odd_dist(0, 99);
+        for(int i = 0; i < 2000; ++i)
+        {
+            int k = 2 * odd_dist(mt_) + 1;
+            if(i % 2 == 0)
+            {
+                tree.insert(k);
+            }
+            else
+            {
+                tree.erase(k);
+            }
+        }
+        done.store(true);
+        for(std::thread& t : readers)
+        {
+            t.join();
+        }
+        tree.synchronize();
+        assert(tree.pending() == 0);
+        assert(reads.load() >= 300);
+        std::cout << "passed test_rcu_concurrent\n";
+    }
+
+//*** 2 tests of Sharded_BST
+    // every operation against std::set, on keys that arrive in
+    // increasing order, which keeps skewing the last shard
+    void test_sharded(void)
+    {
+        Sharded_BST<int> tree(4);
+        std::set<int> real;
+        std::uniform_int_distribution<int> op_dist(0, 9);
+        for(int i = 0; i < 6000; ++i)
+        {
+            int k = i + std::uniform_int_distribution<int>(-100, 100)(mt_);
+            switch(op_dist(mt_))
+            {
+                case 0:
+                {
+                    tree.erase(k);
+                    real.erase(k);
+                    break;
+                }
+                case 1:
+                {
+                    int out = -1;
+                    assert(tree.delete_min(out) == !real.empty());
+                    if(!real.empty())
+                    {
+                        assert(out == *real.begin());
+                        real.erase(real.begin());
+                    }
+                    break;
+                }
+                case 2:
+                {
+                    int out = -1;
+                    auto it = real.find(k);
+                    bool expected = it != real.end() && std::next(it) != real.end();
+                    assert(tree.successor(k, out) == expected);
+                    assert(!expected || out == *std::next(it));
+                    break;
+                }
+                default:
+                {
+                    tree.insert(k);
+                    real.insert(k);
+                    break;
+                }
+            }
+            assert(tree.contains(k) == (real.count(k) == 1));
+        }
+        assert(tree.size() == real.size());
+        assert(tree.make_vec() == std::vector<int>(real.begin(), real.end()));
+        int smallest = -1;
+        assert(tree.min(smallest) && smallest == *real.begin());
+
+        // growth has spread the keys, and an explicit rebalance evens them out
+        std::vector<unsigned> sizes = tree.shard_sizes();
+        assert(sizes.size() == 4);
+        assert(std::count(sizes.begin(), sizes.end(), 0u) == 0);
+        tree.rebalance();
+        sizes = tree.shard_sizes();
+        unsigned largest = *std::max_element(sizes.begin(), sizes.end());
+        unsigned least = *std::min_element(sizes.begin(), sizes.end());
+        assert(largest - least <= 1);
+        assert(tree.make_vec() == std::vector<int>(real.begin(), real.end()));
+
+        // an increasing stream only goes to the last shard, which must
+        // not rebuild until there have been as many inserts as keys at
+        // the last rebuild
+        // The first 1025 keys fill shard 0 and are then split evenly.
+        Sharded_BST<int> increasing(4);
+        for(int i = 0; i < 2000; ++i)
+        {
+            increasing.insert(i);
+        }
+        assert(increasing.shard_sizes() == std::vector<unsigned>({256, 256, 256, 1232}));
+        for(int i = 2000; i < 2050; ++i)
+        {
+            increasing.insert(i);
+        }
+        sizes = increasing.shard_sizes();
+        assert(sizes == std::vector<unsigned>({512, 513, 512, 513}));
+
+        // a sliding window, where erases keep the size flat, must still
+        // be rebalanced as the inserts pile into the last shard
+        // Between rebuilds the last shard fills up again, so the test
+        // samples the layout and wants it spread most of the time.
+        Sharded_BST<int> window(8);
+        const int width = 4000;
+        for(int i = 0; i < width; ++i)
+        {
+            window.insert(i);
+        }
+        int samples = 0;
+        int piled_up = 0;
+        for(int i = width; i < 4 * width; ++i)
+        {
+            window.insert(i);
+            window.erase(i - width);
+            if(i % (width / 8) == 0)
+            {
+                sizes = window.shard_sizes();
+                ++samples;
+                piled_up += *std::max_element(sizes.begin(), sizes.end()) >= width / 4 * 3;
+            }
+        }
+        assert(piled_up <= samples / 2);
+        assert(window.size() == static_cast<unsigned>(width));
+        assert(window.min(smallest) && smallest == 3 * width);
+
+        // successor across the boundary between two shards
+        Sharded_BST<int> split(2, std::vector<int> {0, 100});
+        split.insert(10);
+        split.insert(200);
+        int next = -1;
+        assert(split.shard_sizes() == std::vector<unsigned>({1, 1}));
+        assert(split.successor(10, next) && next == 200);
+        assert(!split.successor(200, next));
+        std::cout << "passed test_sharded\n";
+    }
+
+    // threads insert interleaved keys at the same time, with
+    // rebalances happening on the way, and none may be lost
+    void test_sharded_concurrent(void)
+    {
+        Sharded_BST<int> tree(8);
+        const int threads = 4;
+        const int per_thread = 3000;
+        std::vector<std::thread> writers;
+        for(int t = 0; t < threads; ++t)
+        {
+            writers.emplace_back([&tree, t]()
+            {
+                for(int i = 0; i < per_thread; ++i)
+                {
+                    tree.insert(i * threads + t);
+                    assert(tree.contains(i * threads + t));
+                }
+            });
+        }
+        for(std::thread& w : writers)
+        {
+            w.join();
+        }
+        std::vector<int> expected(threads * per_thread);
+        for(int i = 0; i < threads * per_thread; ++i)
+        {
+            expected[i] = i;
+        }
+        assert(tree.make_vec() == expected);
+        std::cout << "passed test_sharded_concurrent\n";
+    }
+
+//*** 2 tests of save and load
+    void test_save_load(void)
+    {
+        std::vector<int> vec = generate_without_duplicates();
+        BST<int> tree;
+        for(int x : vec)
+        {
+            tree.insert(x);
+        }
+        std::stringstream buffer;
+        assert(tree.save(buffer));
+        BST<int> loaded;
+        loaded.insert(1000);
+        assert(loaded.load(buffer));
+        std::sort(vec.begin(), vec.end());
+        assert(loaded.make_vec() == vec);
+        assert(loaded.size() == vec.size());
+        // the loaded tree is perfectly balanced
+        unsigned balanced_height = 0;
+        while((2u << balanced_height) <= vec.size())
+        {
+            ++balanced_height;
+        }
+        assert(loaded.get_root_value() == vec[vec.size() / 2]);
+        assert(loaded.your_postorder_heights() == loaded.real_postorder_heights());
+        assert(loaded.your_postorder_heights().back() == static_cast<int>(balanced_height));
+        // parent pointers must be usable afterwards
+        assert(loaded.successor(vec[0])->key == vec[1]);
+        loaded.erase(vec[0]);
+        assert(loaded.min()->key == vec[1]);
+
+        // a multiset keeps every copy through the round trip
+        BST<int> multi;
+        multi.set_multiset(true);
+        for(int x : {4, 1, 4, 9, 4, 1, 7})
+        {
+            multi.insert(x);
+        }
+        std::stringstream multi_buffer;
+        assert(multi.save(multi_buffer));
+        BST<int> multi_loaded;
+        assert(multi_loaded.load(multi_buffer));
+        assert(multi_loaded.size() == 7);
+        assert(multi_loaded.count(4) == 3 && multi_loaded.count(1) == 2);
+        assert(multi_loaded.count(7) == 1 && multi_loaded.count(9) == 1);
+        int smallest = 0;
+        assert(multi_loaded.pop_min(smallest) && smallest == 1);
+        assert(multi_loaded.count(1) == 1 && multi_loaded.size() == 6);
+        // only a tree holding copies uses the counted layout
+        assert(multi_buffer.str().compare(0, 4, "DSAM") == 0);
+        assert(buffer.str().compare(0, 4, "DSAT") == 0);
+        // and a zero count is malformed
+        std::string zero_count = multi_buffer.str();
+        std::memset(&zero_count[16 + sizeof(int)], 0, sizeof(unsigned));
+        std::stringstream zero_buffer(zero_count);
+        assert(!multi_loaded.load(zero_buffer));
+        assert(multi_loaded.size() == 6);
+        std::cout << "passed test_save_load\n";
+    }
+
+    void test_save_load_fd(void)
+    {
+        std::vector<std::string> vec {"Sydney", "Melbourne", "Hobart",
+            "Adelaide", "Perth", "Brisbane", "Darwin"};
+        BST<std::string> tree;
+        for(const auto& x : vec)
+        {
+            tree.insert(x);
+        }
+        std::FILE* file = std::tmpfile();
+        assert(file != nullptr);
+        int fd = fileno(file);
+        assert(tree.save(fd));
+        assert(lseek(fd, 0, SEEK_SET) == 0);
+        BST<int> wrong_type;
+        assert(!wrong_type.load(fd));
+        assert(wrong_type.size() == 0);
+        assert(lseek(fd, 0, SEEK_SET) == 0);
+        BST<std::string> loaded;
+        assert(loaded.load(fd));
+        std::fclose(file);
+        std::sort(vec.begin(), vec.end());
+        assert(loaded.make_vec() == vec);
+        std::cout << "passed test_save_load_fd\n";
+    }
+
+    // write in the formats that differ from the list's, and through a
+    // file descriptor with more keys than the buffer holds
+    void test_write(void)
+    {
+        BST<int> tree;
+        for(int x : {5, 2, 8, -3})
+        {
+            tree.insert(x);
+        }
+        std::ostringstream plain;
+        assert(tree.write(plain));
+        assert(plain.str() == "-3 2 5 8\n");
+        Text_options options;
+        options.format = Text_format::json;
+        std::ostringstream json;
+        assert(tree.write(json, options));
+        assert(json.str() == "[-3,2,5,8]\n");
+        options.format = Text_format::csv;
+        options.csv_header = "";
+        std::ostringstream csv;
+        assert(tree.write(csv, options));
+        assert(csv.str() == "-3\n2\n5\n8\n");
+
+        std::vector<int> vec = generate_without_duplicates();
+        BST<int> big;
+        for(int x : vec)
+        {
+            big.insert(x);
+        }
+        for(int i = 0; i < 30000; ++i)
+        {
+            big.insert(1000000 + i);
+        }
+        std::string expected;
+        for(int x : big.make_vec())
+        {
+            expected += std::to_string(x) + '\n';
+        }
+        options.format = Text_format::lines;
+        std::FILE* file = std::tmpfile();
+        assert(file != nullptr);
+        assert(big.write(fileno(file), options));
+        std::rewind(file);
+        std::string written(expected.size() + 1, '\0');
+        assert(std::fread(&written[0], 1, written.size(), file) == expected.size());
+        std::fclose(file);
+        written.resize(expected.size());
+        assert(written == expected);
+        std::cout << "passed test_write\n";
+    }
+
+//*** large scale differential and complexity tests
+
+    // checks keys, size and heights of tree against real
+    void check_against(BST<int>& tree, const std::set<int>& real)
+    {
+        std::vector<int> expected(real.begin(), real.end());
+        assert(tree.make_vec() == expected);
+        assert(tree.size() == real.size());
+        assert(tree.your_postorder_heights() == tree.real_postorder_heights());
+    }
+
+    // Runs random operations on a BST and a std::set side by side, with
+    // keys from each distribution of common/workload.hpp, and asserts
+    // that both always give the same answers
+    void test_differential(std::size_t operations)
+    {
+        const Distribution distributions[] = {Distribution::uniform, Distribution::zipfian,
+            Distribution::duplicate_heavy, Distribution::sorted, Distribution::reversed};
+        for(Distribution d : distributions)
+        {
+            // sorted and reversed keys build a path, so those runs are kept short
+            bool degenerate = (d == Distribution::sorted || d == Distribution::reversed);
+            std::size_t ops = degenerate ? std::min<std::size_t>(operations, 20000) : operations;
+            std::vector<int> keys = make_keys(d, ops, mt_());
+            const std::size_t check_every = std::max<std::size_t>(ops / 8, 1);
+            BST<int> tree;
+            std::set<int> real;
+            std::uniform_int_distribution<int> op_dist(0, 9);
+            for(std::size_t i = 0; i < ops; ++i)
+            {
+                // most operations other than insert use a key seen before,
+                // so that they usually hit a key in the tree
+                int k = keys[std::uniform_int_distribution<std::size_t>(0, i)(mt_)];
+                int op = op_dist(mt_);
+                if(op < 4)
+                {
+                    tree.insert(keys[i]);
+                    real.insert(keys[i]);
+                }
+                else if(op < 6)
+                {
+                    tree.erase(k);
+                    real.erase(k);
+                }
+                else if(op < 8)
+                {
+                    BST<int>::Node* node = tree.find(k);
+                    assert((node != nullptr) == (real.count(k) == 1));
+                    assert(node == nullptr || node->key == k);
+                }
+                else if(op < 9)
+                {
+                    BST<int>::Node* node = tree.successor(k);
+                    auto it = real.find(k);
+                    if(it != real.end())
+                    {
+                        ++it;
+                    }
+                    assert((node == nullptr) == (it == real.end()));
+                    assert(node == nullptr || node->key == *it);
+                }
+                else
+                {
+                    BST<int>::Node* node = tree.min();
+                    assert((node == nullptr) == real.empty());
+                    if(node != nullptr)
+                    {
+                        assert(node->key == *real.begin());
+                        real.erase(real.begin());
+                    }
+                    tree.delete_min();
+                }
+                assert(tree.size() == real.size());
+                if(i % check_every == 0)
+                {
+                    check_against(tree, real);
+                }
+            }
+            check_against(tree, real);
+        }
+        std::cout << "passed test_differential with " << operations << " operations\n";
+    }
+
+    // Fits how the time of n inserts, finds, successors and erases of
+    // random keys grows with n, for BST and for std::set doing the same
+    // work.  Both are O(n log n) and suffer the same cache effects as n
+    // grows, so their exponents should be close.  An exponent about 1
+    // higher than std::set's would mean one of the operations of BST
+    // has become linear.
+    void test_complexity(void)
+    {
+        const std::vector<double> sizes {1 << 14, 1 << 15, 1 << 16, 1 << 17};
+        const std::vector<int> keys = make_keys(Distribution::uniform, 1 << 17, seed_);
+        double exponent = measure_growth(sizes, [&keys](std::size_t n)
+        {
+            BST<int> tree;
+            for(std::size_t i = 0; i < n; ++i)
+            {
+                tree.insert(keys[i]);
+            }
+            for(std::size_t i = 0; i < n; ++i)
+            {
+                assert(tree.find(keys[i]) != nullptr);
+                tree.successor(keys[i]);
+            }
+            for(std::size_t i = 0; i < n; ++i)
+            {
+                tree.erase(keys[i]);
+            }
+            assert(tree.size() == 0);
+        });
+        double reference = measure_growth(sizes, [&keys](std::size_t n)
+        {
+            std::set<int> real;
+            for(std::size_t i = 0; i < n; ++i)
+            {
+                real.insert(keys[i]);
+            }
+            for(std::size_t i = 0; i < n; ++i)
+            {
+                assert(real.find(keys[i]) != real.end());
+                real.upper_bound(keys[i]);
+            }
+            for(std::size_t i = 0; i < n; ++i)
+            {
+                real.erase(keys[i]);
+            }
+            assert(real.empty());
+        });
+        std::cout << "BST growth exponent " << exponent
+                  << ", std::set growth exponent " << reference << '\n';
+        assert(exponent - reference < 0.5);
+        std::cout << "passed test_complexity\n";
+    }
+
+    // Checks the counters of the Count_stats policy and that the
+    // default No_stats policy adds nothing to the size of a tree
+    void test_stats(void)
+    {
+        struct Plain_tree
+        {
+            BST<int>::Node* root;
+            unsigned int size;
+            unsigned int duplicates;
+            bool splay;
+            bool use_finger;
+            bool multiset;
+            BST<int>::Node* finger;
+            void* filter;
+            BST<int>::Node* min;
+            BST<int>::Node* max;
+        };
+        assert(sizeof(BST<int>) == sizeof(Plain_tree));
+
+        std::vector<int> vec = generate_without_duplicates();
+        BST<int, Count_stats> tree;
+        for(int x : vec)
+        {
+            tree.insert(x);
+        }
+        Container_stats inserted = tree.stats();
+        assert(inserted.allocations == vec.size());
+        // every insert but the first fixes at least its parent's height
+        assert(inserted.fix_height_steps >= vec.size() - 1);
+        assert(inserted.rotations == 0);
+
+        tree.reset_stats();
+        assert(tree.find(vec.front()) != nullptr);
+        assert(tree.stats().comparisons == tree.stats().nodes_visited);
+        assert(tree.stats().comparisons <= vec.size());
+
+        BST<int, Count_stats>::Node* node = tree.find(vec.front());
+        if(node->left != nullptr)
+        {
+            tree.rotate_right(node);
+            assert(tree.stats().rotations == 1);
+        }
+        for(int x : vec)
+        {
+            tree.erase(x);
+        }
+        assert(tree.stats().frees == vec.size());
+        std::cout << "passed test_stats\n";
+    }
+
+    // memory_usage follows the nodes, and the filter shows up as
+    // container memory while it is on
+    void test_memory_usage(void)
+    {
+        BST<int> tree;
+        std::vector<int> vec = generate_without_duplicates();
+        for(int x : vec)
+        {
+            tree.insert(x);
+        }
+        Memory_usage m = tree.memory_usage();
+        assert(m.nodes == tree.size());
+        assert(m.node.node_bytes == sizeof(BST<int>::Node));
+        assert(m.node.link_bytes == 3 * sizeof(BST<int>::Node*));
+        assert(m.node.key_bytes + m.node.link_bytes + m.node.other_bytes + m.node.padding_bytes
+               == m.node.node_bytes);
+        assert(m.payload_bytes == tree.size() * sizeof(int));
+        assert(m.container_bytes == sizeof(tree));
+        assert(m.total() == sizeof(tree) + tree.size() * m.node.allocation_bytes);
+
+        tree.set_filter(0.01);
+        Memory_usage filtered = tree.memory_usage();
+        assert(filtered.container_bytes > m.container_bytes);
+        assert(filtered.total() > m.total());
+        tree.set_filter(0);
+        assert(tree.memory_usage().total() == m.total());
+        std::cout << "passed test_memory_usage\n";
+    }
+
+    // Static_set built at compile time, and at run time from
+    // random keys with duplicates, compared against std::set
+    void test_static_set(void)
+    {
+        constexpr Static_set<int, 6> primes {{7, 2, 5, 3, 11, 5}};
+        static_assert(primes.size() == 5, "duplicates are dropped");
+        static_assert(*primes.min() == 2, "keys are sorted");
+        static_assert(*primes.find(7) == 7, "");
+        static_assert(primes.find(4) == nullptr, "");
+        static_assert(*primes.successor(7) == 11, "");
+        static_assert(primes.successor(11) == nullptr, "");
+        static_assert(Static_set<int, 0>(std::array<int, 0>()).min() == nullptr, "");
+
+        std::uniform_int_distribution<int> val_dist(0, 100);
+        std::array<int, 40> keys;
+        std::set<int> real;
+        for(int& k : keys)
+        {
+            k = val_dist(mt_);
+            real.insert(k);
+        }
+        Static_set<int, 40> set {keys};
+        assert(set.size() == real.size());
+        assert(set.make_vec() == std::vector<int>(real.begin(), real.end()));
+        assert(*set.min() == *real.begin());
+        for(int k = -1; k <= 101; ++k)
+        {
+            bool present = real.count(k) != 0;
+            assert((set.find(k) != nullptr) == present);
+            auto next = real.upper_bound(k);
+            if(!present || next == real.end())
+            {
+                assert(set.successor(k) == nullptr);
+            }
+            else
+            {
+                assert(*set.successor(k) == *next);
+            }
+        }
+        std::cout << "passed test_static_set\n";
+    }
 };
 
 #endif
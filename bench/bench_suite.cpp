@@ -0,0 +1,373 @@
+// Benchmark suite for Forward_list and BST
+//
+// Forward_list is measured against std::forward_list and std::vector,
+// BST against std::set and a sorted std::vector, for several sizes and
+// key distributions (see common/workload.hpp) and for string keys.
+// Every measurement is the fastest of a number of trials, each on
+// freshly built data, reported in nanoseconds per element.
+//
+// Build with `make bench` from the top directory, or for example
+//   g++ -std=c++17 -O2 -DNDEBUG bench_suite.cpp -o bench_suite
+// Usage
+//   ./bench_suite [--format=csv|json] [--sizes=1000,10000] [--seed=N] [--trials=N]
+// The output is CSV or JSON on stdout, meant to be diffed between versions.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <forward_list>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../ass1/forward_list.hpp"
+#include "../ass2/bst.hpp"
+#include "../common/workload.hpp"
+
+struct Result
+{
+    std::string container;
+    std::string operation;
+    std::string keys;
+    std::size_t size;
+    double ns_per_op;
+};
+
+class Reporter
+{
+public:
+    void add(const std::string& container, const std::string& operation,
+             const std::string& keys, std::size_t size, double seconds)
+    {
+        double ns = (size == 0) ? 0 : seconds * 1e9 / size;
+        results_.push_back(Result{container, operation, keys, size, ns});
+    }
+
+    void print_csv(std::ostream& out) const
+    {
+        out << "container,operation,keys,size,ns_per_op\n";
+        for(const Result& r : results_)
+        {
+            out << r.container << ',' << r.operation << ',' << r.keys << ','
+                << r.size << ',' << r.ns_per_op << '\n';
+        }
+    }
+
+    void print_json(std::ostream& out) const
+    {
+        out << "[\n";
+        for(std::size_t i = 0; i < results_.size(); ++i)
+        {
+            const Result& r = results_[i];
+            out << "  {\"container\": \"" << r.container
+                << "\", \"operation\": \"" << r.operation
+                << "\", \"keys\": \"" << r.keys
+                << "\", \"size\": " << r.size
+                << ", \"ns_per_op\": " << r.ns_per_op << '}'
+                << (i + 1 < results_.size() ? ",\n" : "\n");
+        }
+        out << "]\n";
+    }
+
+private:
+    std::vector<Result> results_;
+};
+
+// Keeps results alive so that the compiler cannot drop the work
+volatile std::size_t sink = 0;
+
+// Runs body on a fresh state from setup, trials times,
+// and returns the fastest time in seconds.  Only body is timed.
+template <typename Setup, typename Body>
+double best_time(int trials, Setup setup, Body body)
+{
+    double best = 1e300;
+    for(int t = 0; t < trials; ++t)
+    {
+        auto state = setup();
+        auto start = std::chrono::steady_clock::now();
+        body(*state);
+        auto stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(stop - start).count());
+    }
+    return best;
+}
+
+template <typename T>
+std::unique_ptr<Forward_list<T>> make_list(const std::vector<T>& keys)
+{
+    std::unique_ptr<Forward_list<T>> list(new Forward_list<T>());
+    for(auto it = keys.rbegin(); it != keys.rend(); ++it)
+    {
+        list->push_front(*it);
+    }
+    return list;
+}
+
+template <typename T>
+std::unique_ptr<std::forward_list<T>> make_std_list(const std::vector<T>& keys)
+{
+    return std::unique_ptr<std::forward_list<T>>(
+        new std::forward_list<T>(keys.begin(), keys.end()));
+}
+
+template <typename T>
+void bench_lists(Reporter& report, const std::string& name,
+                 const std::vector<T>& keys, int trials)
+{
+    const std::size_t n = keys.size();
+    std::vector<T> first_half(keys.begin(), keys.begin() + n / 2);
+    std::vector<T> second_half(keys.begin() + n / 2, keys.end());
+    std::sort(first_half.begin(), first_half.end());
+    std::sort(second_half.begin(), second_half.end());
+    auto empty_list = []() { return std::unique_ptr<Forward_list<T>>(new Forward_list<T>()); };
+    auto full_list = [&keys]() { return make_list(keys); };
+    auto halves = [&]()
+    {
+        return std::unique_ptr<std::pair<std::unique_ptr<Forward_list<T>>, std::unique_ptr<Forward_list<T>>>>(
+            new std::pair<std::unique_ptr<Forward_list<T>>, std::unique_ptr<Forward_list<T>>>(
+                make_list(first_half), make_list(second_half)));
+    };
+
+    // Forward_list
+    report.add("Forward_list", "push_front", name, n, best_time(trials, empty_list,
+        [&keys](Forward_list<T>& l) { for(const T& k : keys) l.push_front(k); }));
+    report.add("Forward_list", "pop_front", name, n, best_time(trials, full_list,
+        [](Forward_list<T>& l) { while(!l.empty()) l.pop_front(); }));
+    report.add("Forward_list", "copy", name, n, best_time(trials, full_list,
+        [](Forward_list<T>& l) { Forward_list<T> copy(l); sink = sink + copy.size(); }));
+    report.add("Forward_list", "merge", name, n, best_time(trials, halves,
+        [](auto& p) { p.first->merge(*p.second); sink = sink + p.first->size(); }));
+    report.add("Forward_list", "split", name, n, best_time(trials, full_list,
+        [](Forward_list<T>& l) { Forward_list<T> second = l.split(); sink = sink + second.size(); }));
+    report.add("Forward_list", "sort", name, n, best_time(trials, full_list,
+        [](Forward_list<T>& l) { l.sort(); }));
+
+    // std::forward_list
+    auto std_halves = [&]()
+    {
+        return std::unique_ptr<std::pair<std::forward_list<T>, std::forward_list<T>>>(
+            new std::pair<std::forward_list<T>, std::forward_list<T>>(
+                std::forward_list<T>(first_half.begin(), first_half.end()),
+                std::forward_list<T>(second_half.begin(), second_half.end())));
+    };
+    auto std_full = [&keys]() { return make_std_list(keys); };
+    report.add("std::forward_list", "push_front", name, n, best_time(trials,
+        []() { return std::unique_ptr<std::forward_list<T>>(new std::forward_list<T>()); },
+        [&keys](std::forward_list<T>& l) { for(const T& k : keys) l.push_front(k); }));
+    report.add("std::forward_list", "pop_front", name, n, best_time(trials, std_full,
+        [](std::forward_list<T>& l) { while(!l.empty()) l.pop_front(); }));
+    report.add("std::forward_list", "copy", name, n, best_time(trials, std_full,
+        [](std::forward_list<T>& l) { std::forward_list<T> copy(l); sink = sink + copy.empty(); }));
+    report.add("std::forward_list", "merge", name, n, best_time(trials, std_halves,
+        [](auto& p) { p.first.merge(p.second); sink = sink + p.first.empty(); }));
+    // std::forward_list has no split, walk to the middle and splice
+    report.add("std::forward_list", "split", name, n, best_time(trials, std_full,
+        [n](std::forward_list<T>& l)
+        {
+            std::forward_list<T> second;
+            if(n > 1)
+            {
+                auto it = l.begin();
+                std::advance(it, (n + 1) / 2 - 1);
+                second.splice_after(second.before_begin(), l, it, l.end());
+            }
+            sink = sink + second.empty();
+        }));
+    report.add("std::forward_list", "sort", name, n, best_time(trials, std_full,
+        [](std::forward_list<T>& l) { l.sort(); }));
+
+    // std::vector
+    auto vec_full = [&keys]() { return std::unique_ptr<std::vector<T>>(new std::vector<T>(keys)); };
+    report.add("std::vector", "push_back", name, n, best_time(trials,
+        []() { return std::unique_ptr<std::vector<T>>(new std::vector<T>()); },
+        [&keys](std::vector<T>& v) { for(const T& k : keys) v.push_back(k); }));
+    report.add("std::vector", "pop_back", name, n, best_time(trials, vec_full,
+        [](std::vector<T>& v) { while(!v.empty()) v.pop_back(); }));
+    report.add("std::vector", "copy", name, n, best_time(trials, vec_full,
+        [](std::vector<T>& v) { std::vector<T> copy(v); sink = sink + copy.size(); }));
+    report.add("std::vector", "merge", name, n, best_time(trials,
+        [&]()
+        {
+            std::unique_ptr<std::vector<T>> v(new std::vector<T>(first_half));
+            v->insert(v->end(), second_half.begin(), second_half.end());
+            return v;
+        },
+        [n](std::vector<T>& v) { std::inplace_merge(v.begin(), v.begin() + n / 2, v.end()); }));
+    report.add("std::vector", "sort", name, n, best_time(trials, vec_full,
+        [](std::vector<T>& v) { std::stable_sort(v.begin(), v.end()); }));
+}
+
+template <typename T>
+std::unique_ptr<BST<T>> make_tree(const std::vector<T>& keys)
+{
+    std::unique_ptr<BST<T>> tree(new BST<T>());
+    for(const T& k : keys)
+    {
+        tree->insert(k);
+    }
+    return tree;
+}
+
+template <typename T>
+void bench_trees(Reporter& report, const std::string& name,
+                 const std::vector<T>& keys, int trials, std::uint64_t seed)
+{
+    const std::size_t n = keys.size();
+    // lookups and erasures visit the keys in a random order
+    std::vector<T> shuffled = keys;
+    std::mt19937_64 mt(seed + 1);
+    std::shuffle(shuffled.begin(), shuffled.end(), mt);
+    std::vector<T> sorted_keys = keys;
+    std::sort(sorted_keys.begin(), sorted_keys.end());
+    sorted_keys.erase(std::unique(sorted_keys.begin(), sorted_keys.end()), sorted_keys.end());
+
+    // BST
+    auto full_tree = [&keys]() { return make_tree(keys); };
+    report.add("BST", "insert", name, n, best_time(trials,
+        []() { return std::unique_ptr<BST<T>>(new BST<T>()); },
+        [&keys](BST<T>& t) { for(const T& k : keys) t.insert(k); }));
+    report.add("BST", "find", name, n, best_time(trials, full_tree,
+        [&shuffled](BST<T>& t) { for(const T& k : shuffled) sink = sink + (t.find(k) != nullptr); }));
+    report.add("BST", "successor", name, n, best_time(trials, full_tree,
+        [&shuffled](BST<T>& t) { for(const T& k : shuffled) sink = sink + (t.successor(k) != nullptr); }));
+    report.add("BST", "erase", name, n, best_time(trials, full_tree,
+        [&shuffled](BST<T>& t) { for(const T& k : shuffled) t.erase(k); }));
+    report.add("BST", "delete_min", name, n, best_time(trials, full_tree,
+        [](BST<T>& t) { while(t.size() > 0) t.delete_min(); }));
+    // a find of a random key followed by a rotation there, if possible
+    report.add("BST", "find+rotate_right", name, n, best_time(trials, full_tree,
+        [&shuffled](BST<T>& t)
+        {
+            for(const T& k : shuffled)
+            {
+                typename BST<T>::Node* node = t.find(k);
+                if(node != nullptr && node->left != nullptr)
+                {
+                    t.rotate_right(node);
+                }
+            }
+        }));
+
+    // std::set
+    auto full_set = [&keys]() { return std::unique_ptr<std::set<T>>(new std::set<T>(keys.begin(), keys.end())); };
+    report.add("std::set", "insert", name, n, best_time(trials,
+        []() { return std::unique_ptr<std::set<T>>(new std::set<T>()); },
+        [&keys](std::set<T>& s) { for(const T& k : keys) s.insert(k); }));
+    report.add("std::set", "find", name, n, best_time(trials, full_set,
+        [&shuffled](std::set<T>& s) { for(const T& k : shuffled) sink = sink + (s.find(k) != s.end()); }));
+    report.add("std::set", "successor", name, n, best_time(trials, full_set,
+        [&shuffled](std::set<T>& s) { for(const T& k : shuffled) sink = sink + (s.upper_bound(k) != s.end()); }));
+    report.add("std::set", "erase", name, n, best_time(trials, full_set,
+        [&shuffled](std::set<T>& s) { for(const T& k : shuffled) s.erase(k); }));
+    report.add("std::set", "delete_min", name, n, best_time(trials, full_set,
+        [](std::set<T>& s) { while(!s.empty()) s.erase(s.begin()); }));
+
+    // sorted std::vector, built in one go as it has no cheap insert
+    report.add("sorted std::vector", "insert_bulk", name, n, best_time(trials,
+        []() { return std::unique_ptr<std::vector<T>>(new std::vector<T>()); },
+        [&keys](std::vector<T>& v)
+        {
+            v.assign(keys.begin(), keys.end());
+            std::sort(v.begin(), v.end());
+            v.erase(std::unique(v.begin(), v.end()), v.end());
+        }));
+    auto sorted_vec = [&sorted_keys]() { return std::unique_ptr<std::vector<T>>(new std::vector<T>(sorted_keys)); };
+    report.add("sorted std::vector", "find", name, n, best_time(trials, sorted_vec,
+        [&shuffled](std::vector<T>& v)
+        {
+            for(const T& k : shuffled) sink = sink + std::binary_search(v.begin(), v.end(), k);
+        }));
+    report.add("sorted std::vector", "successor", name, n, best_time(trials, sorted_vec,
+        [&shuffled](std::vector<T>& v)
+        {
+            for(const T& k : shuffled) sink = sink + (std::upper_bound(v.begin(), v.end(), k) != v.end());
+        }));
+}
+
+// BST is not balanced, so sorted and reversed keys build a path and
+// every operation is linear.  Those cases are only run at small sizes.
+const std::size_t max_degenerate_tree = 20000;
+
+int main(int argc, char** argv)
+{
+    std::string format = "csv";
+    std::vector<std::size_t> sizes {1000, 10000, 100000};
+    std::uint64_t seed = 42;
+    int trials = 3;
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        // any other format is unknown and gets the usage below
+        if(arg == "--format=csv" || arg == "--format=json")
+        {
+            format = arg.substr(9);
+        }
+        else if(arg.rfind("--sizes=", 0) == 0)
+        {
+            sizes.clear();
+            std::stringstream list(arg.substr(8));
+            std::string item;
+            while(std::getline(list, item, ','))
+            {
+                sizes.push_back(std::strtoull(item.c_str(), nullptr, 10));
+            }
+        }
+        else if(arg.rfind("--seed=", 0) == 0)
+        {
+            seed = std::strtoull(arg.c_str() + 7, nullptr, 10);
+        }
+        else if(arg.rfind("--trials=", 0) == 0)
+        {
+            trials = std::max(1, std::atoi(arg.c_str() + 9));
+        }
+        else
+        {
+            // an explicit --help is not an error, anything unknown is
+            const bool help = arg == "--help" || arg == "-h";
+            (help ? std::cout : std::cerr)
+                << "usage: " << argv[0]
+                << " [--format=csv|json] [--sizes=1000,10000] [--seed=N] [--trials=N]\n";
+            return help ? 0 : 1;
+        }
+    }
+
+    Reporter report;
+    const Distribution distributions[] = {Distribution::uniform, Distribution::sorted,
+                                          Distribution::reversed, Distribution::zipfian};
+    for(std::size_t n : sizes)
+    {
+        for(Distribution d : distributions)
+        {
+            std::vector<int> keys = make_keys(d, n, seed);
+            bench_lists(report, distribution_name(d), keys, trials);
+            bool degenerate = (d == Distribution::sorted || d == Distribution::reversed);
+            if(!degenerate || n <= max_degenerate_tree)
+            {
+                bench_trees(report, distribution_name(d), keys, trials, seed);
+            }
+            else
+            {
+                std::cerr << "skipping BST with " << distribution_name(d)
+                          << " keys at size " << n << '\n';
+            }
+        }
+        std::vector<std::string> strings = make_string_keys(Distribution::uniform, n, seed);
+        bench_lists(report, "string", strings, trials);
+        bench_trees(report, "string", strings, trials, seed);
+    }
+
+    if(format == "json")
+    {
+        report.print_json(std::cout);
+    }
+    else
+    {
+        report.print_csv(std::cout);
+    }
+    return 0;
+}
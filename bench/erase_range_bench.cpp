@@ -0,0 +1,78 @@
+// Benchmark of BST bulk removal, erase_below and erase_range, against
+// removing the same keys one at a time
+//
+// Build with optimisation, for example
+//   g++ -std=c++17 -O2 -DNDEBUG erase_range_bench.cpp -o erase_range_bench
+// Usage
+//   ./erase_range_bench [keys]
+// The keys are inserted in random order, and each pattern removes half
+// of them from a fresh tree
+//   below   the smaller half, by erase_below or delete_min
+//   middle  the middle half, by erase_range or erase of every key
+// Prints one CSV line per pattern and method.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../ass2/bst.hpp"
+
+typedef BST<int> Tree;
+
+void build(Tree& tree, const std::vector<int>& keys)
+{
+    for(int k : keys)
+    {
+        tree.insert(k);
+    }
+}
+
+template <typename Fn>
+void run(const char* pattern, const char* method, const std::vector<int>& keys, Fn remove,
+         long long& checksum)
+{
+    Tree tree;
+    build(tree, keys);
+    auto start = std::chrono::steady_clock::now();
+    remove(tree);
+    auto stop = std::chrono::steady_clock::now();
+    checksum += tree.size();
+    std::cout << pattern << ',' << method << ',' << keys.size() << ','
+              << std::chrono::duration<double>(stop - start).count() << '\n';
+}
+
+int main(int argc, char** argv)
+{
+    const int n = (argc > 1) ? std::atoi(argv[1]) : 1000000;
+    std::vector<int> keys(n);
+    for(int i = 0; i < n; ++i)
+    {
+        keys[i] = i;
+    }
+    std::mt19937_64 mt(7);
+    std::shuffle(keys.begin(), keys.end(), mt);
+
+    std::cout << "pattern,method,keys,seconds\n";
+    long long checksum = 0;
+    run("below", "delete_min", keys, [n](Tree& tree)
+    {
+        for(int i = 0; i < n / 2; ++i)
+        {
+            tree.delete_min();
+        }
+    }, checksum);
+    run("below", "erase_below", keys, [n](Tree& tree) { tree.erase_below(n / 2); }, checksum);
+    run("middle", "erase", keys, [n](Tree& tree)
+    {
+        for(int k = n / 4; k < n / 4 * 3; ++k)
+        {
+            tree.erase(k);
+        }
+    }, checksum);
+    run("middle", "erase_range", keys, [n](Tree& tree) { tree.erase_range(n / 4, n / 4 * 3); },
+        checksum);
+    std::cerr << "checksum " << checksum << '\n';
+    return 0;
+}
@@ -0,0 +1,87 @@
+// Benchmark of external_sort on a data set several times the memory budget
+//
+// Build with optimisation, for example
+//   g++ -std=c++17 -O2 -DNDEBUG external_sort_bench.cpp -o external_sort_bench
+// Usage
+//   ./external_sort_bench [elements] [memory budget in MiB]
+// Prints one CSV line per configuration.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include "../ass1/external_sort.hpp"
+
+int main(int argc, char** argv)
+{
+    const std::uint64_t elements = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 8000000;
+    const std::size_t budget_mib = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 16;
+    const std::string input_path = "external_sort_bench.in";
+    const std::string output_path = "external_sort_bench.out";
+
+    // fixed seed so that runs can be compared between versions
+    {
+        std::mt19937_64 mt(42);
+        std::ofstream input(input_path, std::ios::binary);
+        Binary_writer writer(input);
+        for(std::uint64_t i = 0; i < elements; ++i)
+        {
+            std::uint64_t value = mt();
+            writer.write(&value, sizeof(value));
+        }
+    }
+
+    std::cout << "benchmark,elements,data_bytes,node_bytes,budget_bytes,max_fan_in,seconds\n";
+    for(unsigned fan_in : {4u, 64u})
+    {
+        External_sort_options options;
+        options.memory_budget = budget_mib << 20;
+        options.max_fan_in = fan_in;
+        std::ifstream input(input_path, std::ios::binary);
+        std::ofstream output(output_path, std::ios::binary);
+
+        auto start = std::chrono::steady_clock::now();
+        bool ok = external_sort<std::uint64_t>(input, output, options);
+        output.close();
+        auto stop = std::chrono::steady_clock::now();
+        if(!ok)
+        {
+            std::cerr << "external_sort failed\n";
+            return 1;
+        }
+
+        // check the result really is sorted and complete
+        std::ifstream check(output_path, std::ios::binary);
+        std::uint64_t prev = 0;
+        std::uint64_t value = 0;
+        std::uint64_t count = 0;
+        while(check.read(reinterpret_cast<char*>(&value), sizeof(value)))
+        {
+            if(value < prev)
+            {
+                std::cerr << "output is not sorted\n";
+                return 1;
+            }
+            prev = value;
+            ++count;
+        }
+        if(count != elements)
+        {
+            std::cerr << "output has " << count << " of " << elements << " elements\n";
+            return 1;
+        }
+
+        std::cout << "external_sort," << elements << ','
+                  << elements * sizeof(std::uint64_t) << ','
+                  << elements * sizeof(Forward_list<std::uint64_t>::Node) << ','
+                  << options.memory_budget << ',' << fan_in << ','
+                  << std::chrono::duration<double>(stop - start).count() << '\n';
+    }
+    std::remove(input_path.c_str());
+    std::remove(output_path.c_str());
+    return 0;
+}
@@ -0,0 +1,64 @@
+// Benchmark of BST::find with and without the membership filter on a
+// workload where most lookups are for keys that are not in the tree
+//
+// Build with optimisation, for example
+//   g++ -std=c++17 -O2 -DNDEBUG filter_bench.cpp -o filter_bench
+// Usage
+//   ./filter_bench [keys] [lookups] [share of lookups that miss]
+// Prints one CSV line per false positive rate, 0 meaning no filter,
+// with the lookup time and the counters of the filter.
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../ass2/bst.hpp"
+
+int main(int argc, char** argv)
+{
+    const std::size_t n = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    const std::size_t m = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 2000000;
+    const double miss_share = (argc > 3) ? std::strtod(argv[3], nullptr) : 0.8;
+
+    // even keys are in the tree, odd keys never are
+    std::mt19937_64 mt(42);
+    std::uniform_int_distribution<int> half(0, (1 << 30) - 1);
+    std::vector<int> keys(n);
+    for(int& k : keys)
+    {
+        k = 2 * half(mt);
+    }
+    std::bernoulli_distribution miss(miss_share);
+    std::uniform_int_distribution<std::size_t> pick(0, n - 1);
+    std::vector<int> lookups(m);
+    for(int& k : lookups)
+    {
+        k = miss(mt) ? 2 * half(mt) + 1 : keys[pick(mt)];
+    }
+
+    BST<int> tree;
+    for(int k : keys)
+    {
+        tree.insert(k);
+    }
+
+    std::cout << "false_positive_rate,keys,lookups,seconds,hit_rate,measured_false_positive_rate\n";
+    std::size_t found = 0;
+    for(double rate : {0.0, 0.05, 0.01, 0.001})
+    {
+        tree.set_filter(rate);
+        auto start = std::chrono::steady_clock::now();
+        for(int k : lookups)
+        {
+            found += (tree.find(k) != nullptr);
+        }
+        auto stop = std::chrono::steady_clock::now();
+        Filter_stats stats = tree.filter_stats();
+        std::cout << rate << ',' << tree.size() << ',' << m << ','
+                  << std::chrono::duration<double>(stop - start).count() << ','
+                  << stats.hit_rate() << ',' << stats.false_positive_rate() << '\n';
+    }
+    std::cerr << "found " << found << '\n';
+    return 0;
+}
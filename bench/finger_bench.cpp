@@ -0,0 +1,92 @@
+// Benchmark of the BST finger cache on sequential and near-sequential
+// access, against the same searches started from the root
+//
+// Build with optimisation, for example
+//   g++ -std=c++17 -O2 -DNDEBUG finger_bench.cpp -o finger_bench
+// Usage
+//   ./finger_bench [keys]
+// The keys are inserted in random order.  The patterns are
+//   scan        successor from the minimum to the maximum
+//   sequential  find of every key in increasing order
+//   near        find of every key in an order where each key is at
+//               most 16 positions away from its place in sorted order
+//   random      find of every key in random order, where the finger
+//               cannot help
+// Prints one CSV line per pattern and mode, with the time and the
+// average number of nodes visited per operation.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../ass2/bst.hpp"
+#include "../common/workload.hpp"
+
+typedef BST<int, Count_stats> Tree;
+
+// runs one pattern and prints its line
+// found receives a checksum, so that nothing is optimised away
+void run(Tree& tree, const char* pattern, const std::vector<int>& order, long long& found)
+{
+    tree.reset_stats();
+    auto start = std::chrono::steady_clock::now();
+    if(order.empty())
+    {
+        for(Tree::Node* node = tree.min(); node != nullptr; node = tree.successor(node->key))
+        {
+            found += node->key;
+        }
+    }
+    else
+    {
+        for(int k : order)
+        {
+            found += (tree.find(k) != nullptr);
+        }
+    }
+    auto stop = std::chrono::steady_clock::now();
+    double ops = order.empty() ? tree.size() : order.size();
+    std::cout << pattern << ',' << (tree.finger() ? "finger" : "root") << ','
+              << tree.size() << ',' << std::chrono::duration<double>(stop - start).count() << ','
+              << tree.stats().nodes_visited / ops << '\n';
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t n = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    std::vector<int> keys = make_keys(Distribution::uniform, n, 42);
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    std::vector<int> sequential = keys;
+    std::vector<int> near = keys;
+    std::mt19937_64 mt(7);
+    for(std::size_t i = 0; i < near.size(); i += 16)
+    {
+        std::shuffle(near.begin() + i, near.begin() + std::min(near.size(), i + 16), mt);
+    }
+    std::vector<int> random = keys;
+    std::shuffle(random.begin(), random.end(), mt);
+
+    Tree tree;
+    for(int k : random)
+    {
+        tree.insert(k);
+    }
+    std::shuffle(random.begin(), random.end(), mt);
+
+    std::cout << "pattern,mode,keys,seconds,visits_per_op\n";
+    long long found = 0;
+    for(bool finger : {false, true})
+    {
+        tree.set_finger(finger);
+        run(tree, "scan", std::vector<int>(), found);
+        run(tree, "sequential", sequential, found);
+        run(tree, "near", near, found);
+        run(tree, "random", random, found);
+    }
+    std::cerr << "checksum " << found << '\n';
+    return 0;
+}
@@ -0,0 +1,103 @@
+// Benchmark of the strategies of Forward_list::sort for types without
+// a Radix_key: merge sort, and gather-sort-relink on one thread and
+// on every hardware thread
+//
+// Build with optimisation, for example
+//   g++ -std=c++17 -O2 -DNDEBUG -pthread gather_sort_bench.cpp -o gather_sort_bench
+// Usage
+//   ./gather_sort_bench [sizes...]
+// The default sizes are 100k and 1M elements.  The key types are
+// double (gathered with its key), a 16 byte record and std::string
+// (gathered as node pointers).
+// Prints one CSV line per key type, method and size.
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../ass1/forward_list.hpp"
+#include "../common/workload.hpp"
+
+struct Record
+{
+    long long key;
+    long long payload;
+    bool operator<(const Record& other) const { return key < other.key; }
+};
+
+// builds a list of the values, sorts it with options and returns the
+// seconds the sort took, or a negative number if the result is wrong
+template <typename T>
+double time_sort(const std::vector<T>& values, const Sort_options& options)
+{
+    Forward_list<T> list;
+    for(const T& v : values)
+    {
+        list.push_front(v);
+    }
+    auto start = std::chrono::steady_clock::now();
+    list.sort(options);
+    auto stop = std::chrono::steady_clock::now();
+    T prev = list.front();
+    for(; !list.empty(); list.pop_front())
+    {
+        if(list.front() < prev)
+        {
+            return -1;
+        }
+        prev = list.front();
+    }
+    return std::chrono::duration<double>(stop - start).count();
+}
+
+template <typename T>
+bool run(const char* type, const std::vector<T>& values)
+{
+    Sort_options merge;
+    merge.memory_budget = 0;
+    Sort_options gather;
+    Sort_options parallel;
+    parallel.threads = std::max(1u, std::thread::hardware_concurrency());
+
+    double seconds[3] = {time_sort(values, merge), time_sort(values, gather),
+                         time_sort(values, parallel)};
+    std::cout << type << ",merge," << values.size() << ',' << seconds[0] << '\n'
+              << type << ",gather," << values.size() << ',' << seconds[1] << '\n'
+              << type << ",gather_" << parallel.threads << "_threads," << values.size() << ','
+              << seconds[2] << '\n';
+    return seconds[0] >= 0 && seconds[1] >= 0 && seconds[2] >= 0;
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::size_t> sizes;
+    for(int i = 1; i < argc; ++i)
+    {
+        sizes.push_back(std::strtoull(argv[i], nullptr, 10));
+    }
+    if(sizes.empty())
+    {
+        sizes = {100000, 1000000};
+    }
+    std::cout << "key,method,elements,seconds\n";
+    for(std::size_t n : sizes)
+    {
+        std::vector<int> keys = make_keys(Distribution::uniform, n, 42);
+        std::vector<double> doubles(keys.begin(), keys.end());
+        std::vector<Record> records(n);
+        for(std::size_t i = 0; i < n; ++i)
+        {
+            records[i] = Record {keys[i], static_cast<long long>(i)};
+        }
+        std::vector<std::string> strings = make_string_keys(Distribution::uniform, n, 42);
+        if(!run("double", doubles) || !run("record", records) || !run("string", strings))
+        {
+            std::cerr << "sort result is wrong\n";
+            return 1;
+        }
+    }
+    return 0;
+}
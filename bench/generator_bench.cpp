@@ -0,0 +1,61 @@
+// Benchmark of reading the first keys of a BST in order, through
+// make_vec, which copies the whole tree first, and through the lazy
+// in_order generator stopped by taken
+//
+// Needs C++20 for the coroutines, build with optimisation, for example
+//   g++ -std=c++20 -O2 -DNDEBUG generator_bench.cpp -o generator_bench
+// Usage
+//   ./generator_bench [keys] [repetitions]
+// Prints one CSV line per method and number of keys read.
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../ass2/bst.hpp"
+
+int main(int argc, char** argv)
+{
+    const std::size_t n = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    const std::size_t reps = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 20;
+
+    std::mt19937_64 mt(42);
+    BST<long long> tree;
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        tree.insert(static_cast<long long>(mt() >> 1));
+    }
+
+    std::cout << "method,keys_read,tree_size,seconds_per_read\n";
+    long long sum = 0;
+    for(std::size_t wanted : {std::size_t(100), std::size_t(500), std::size_t(n)})
+    {
+        auto start = std::chrono::steady_clock::now();
+        for(std::size_t r = 0; r < reps; ++r)
+        {
+            std::vector<long long> keys = tree.make_vec();
+            for(std::size_t i = 0; i < wanted && i < keys.size(); ++i)
+            {
+                sum += keys[i];
+            }
+        }
+        auto stop = std::chrono::steady_clock::now();
+        std::cout << "make_vec," << wanted << ',' << tree.size() << ','
+                  << std::chrono::duration<double>(stop - start).count() / reps << '\n';
+
+        start = std::chrono::steady_clock::now();
+        for(std::size_t r = 0; r < reps; ++r)
+        {
+            for(long long k : taken(tree.in_order(), wanted))
+            {
+                sum += k;
+            }
+        }
+        stop = std::chrono::steady_clock::now();
+        std::cout << "in_order," << wanted << ',' << tree.size() << ','
+                  << std::chrono::duration<double>(stop - start).count() / reps << '\n';
+    }
+    std::cerr << "checksum " << sum << '\n';
+    return 0;
+}
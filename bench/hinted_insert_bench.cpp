@@ -0,0 +1,102 @@
+// Benchmark of hinted BST insertion, insert(hint, k) with the node
+// returned for the previous key as hint, against insert(k) from the root
+//
+// Build with optimisation, for example
+//   g++ -std=c++17 -O2 -DNDEBUG hinted_insert_bench.cpp -o hinted_insert_bench
+// Usage
+//   ./hinted_insert_bench [keys]
+// The streams are
+//   increasing  every key larger than the one before
+//   near        increasing, but shuffled within blocks of 16 keys
+//   random      random order, where the hint rarely fits
+// Each stream is inserted without and with splaying.  Without
+// rebalancing an increasing stream builds a chain, so the default
+// size is small, and above 100000 keys only splaying is run.
+// Prints one CSV line per stream, mode and method, with the time and
+// the average number of nodes visited and heights fixed per insert.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <vector>
+#include "../ass2/bst.hpp"
+
+typedef BST<int, Count_stats> Tree;
+
+// inserts keys into a new tree and prints the line
+// checksum receives the root, so that nothing is optimised away
+void run(const char* stream, const std::vector<int>& keys, bool splay, bool hinted,
+         long long& checksum)
+{
+    Tree tree;
+    tree.set_splay(splay);
+    auto start = std::chrono::steady_clock::now();
+    if(hinted)
+    {
+        Tree::Node* hint = nullptr;
+        for(int k : keys)
+        {
+            hint = tree.insert(hint, k);
+        }
+    }
+    else
+    {
+        for(int k : keys)
+        {
+            tree.insert(k);
+        }
+    }
+    auto stop = std::chrono::steady_clock::now();
+    checksum += tree.get_root_value();
+    Container_stats stats = tree.stats();
+    double ops = keys.size();
+    std::cout << stream << ',' << (splay ? "splay" : "plain") << ','
+              << (hinted ? "hinted" : "root") << ',' << keys.size() << ','
+              << std::chrono::duration<double>(stop - start).count() << ','
+              << stats.nodes_visited / ops << ',' << stats.fix_height_steps / ops << '\n';
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t n = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 20000;
+    std::vector<int> increasing(n);
+    std::iota(increasing.begin(), increasing.end(), 0);
+
+    std::mt19937_64 mt(7);
+    std::vector<int> near = increasing;
+    for(std::size_t i = 0; i < near.size(); i += 16)
+    {
+        std::shuffle(near.begin() + i, near.begin() + std::min(near.size(), i + 16), mt);
+    }
+    std::vector<int> random = increasing;
+    std::shuffle(random.begin(), random.end(), mt);
+
+    std::cout << "stream,mode,method,keys,seconds,visits_per_op,fix_height_steps_per_op\n";
+    long long checksum = 0;
+    for(bool splay : {false, true})
+    {
+        if(!splay && n > 100000)
+        {
+            continue;
+        }
+        // both methods of a stream run back to back, so that they
+        // find the allocator in much the same state
+        for(bool hinted : {false, true})
+        {
+            run("increasing", increasing, splay, hinted, checksum);
+        }
+        for(bool hinted : {false, true})
+        {
+            run("near", near, splay, hinted, checksum);
+        }
+        for(bool hinted : {false, true})
+        {
+            run("random", random, splay, hinted, checksum);
+        }
+    }
+    std::cerr << "checksum " << checksum << '\n';
+    return 0;
+}
@@ -0,0 +1,91 @@
+// Benchmark of Forward_list::merge_all against merging the same lists
+// pairwise from left to right with Forward_list::merge
+//
+// Build with optimisation, for example
+//   g++ -std=c++17 -O2 -DNDEBUG merge_all_bench.cpp -o merge_all_bench
+// Usage
+//   ./merge_all_bench [total elements]
+// Prints one CSV line per method and number of lists.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../ass1/forward_list.hpp"
+
+// k sorted lists holding total random elements between them
+std::vector<Forward_list<int>> make_lists(unsigned k, unsigned total, unsigned seed)
+{
+    std::mt19937 mt(seed);
+    std::vector<std::vector<int>> values(k);
+    for(unsigned i = 0; i < total; ++i)
+    {
+        values[mt() % k].push_back(static_cast<int>(mt()));
+    }
+    std::vector<Forward_list<int>> lists(k);
+    for(unsigned i = 0; i < k; ++i)
+    {
+        std::sort(values[i].rbegin(), values[i].rend());
+        for(int x : values[i])
+        {
+            lists[i].push_front(x);
+        }
+    }
+    return lists;
+}
+
+bool is_sorted(Forward_list<int>& list, unsigned total)
+{
+    if(list.size() != total)
+    {
+        return false;
+    }
+    int prev = list.front();
+    for(; !list.empty(); list.pop_front())
+    {
+        if(list.front() < prev)
+        {
+            return false;
+        }
+        prev = list.front();
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    const unsigned total = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    std::cout << "benchmark,lists,elements,seconds\n";
+    for(unsigned k : {8u, 64u, 1024u})
+    {
+        for(int method = 0; method < 2; ++method)
+        {
+            std::vector<Forward_list<int>> lists = make_lists(k, total, 42);
+            Forward_list<int> result;
+            auto start = std::chrono::steady_clock::now();
+            if(method == 0)
+            {
+                result.merge_all(lists);
+            }
+            else
+            {
+                for(Forward_list<int>& list : lists)
+                {
+                    result.merge(list);
+                }
+            }
+            auto stop = std::chrono::steady_clock::now();
+            if(!is_sorted(result, total))
+            {
+                std::cerr << "merge result is wrong\n";
+                return 1;
+            }
+            std::cout << (method == 0 ? "merge_all" : "pairwise_merge") << ','
+                      << k << ',' << total << ','
+                      << std::chrono::duration<double>(stop - start).count() << '\n';
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,93 @@
+// Benchmark of writing keys as text, one operator<< per key as print
+// and display used to do, against Text_writer to a stream and to a
+// file descriptor.  The keys are formatted from a vector, to measure
+// the output alone, and then by BST::write, which adds the walk
+// through the tree.
+//
+// Build with optimisation, for example
+//   g++ -std=c++17 -O2 -DNDEBUG output_bench.cpp -o output_bench
+// Usage
+//   ./output_bench [keys] [file]
+// The text goes to file, /dev/null by default.
+// Prints one CSV line per method.
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include "../ass2/bst.hpp"
+
+template <typename Fn>
+double seconds(Fn fn)
+{
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(stop - start).count();
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t n = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    const char* path = (argc > 2) ? argv[2] : "/dev/null";
+
+    std::mt19937_64 mt(42);
+    BST<long long> tree;
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        tree.insert(static_cast<long long>(mt() >> 1));
+    }
+    std::vector<long long> keys = tree.make_vec();
+
+    std::cout << "method,keys,seconds\n";
+    {
+        std::ofstream out(path);
+        std::cout << "operator<<," << keys.size() << ',' << seconds([&]()
+        {
+            for(long long k : keys)
+            {
+                out << k << '\n';
+            }
+            out << std::flush;
+        }) << '\n';
+    }
+    Text_options lines;
+    lines.format = Text_format::lines;
+    Text_options json;
+    json.format = Text_format::json;
+    {
+        std::ofstream out(path);
+        std::cout << "text_writer_stream," << keys.size() << ',' << seconds([&]()
+        {
+            Text_writer writer(out, lines);
+            for(long long k : keys)
+            {
+                writer.element(k);
+            }
+        }) << '\n';
+    }
+    int fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0)
+    {
+        std::cerr << "cannot open " << path << '\n';
+        return 1;
+    }
+    std::cout << "text_writer_fd," << keys.size() << ',' << seconds([&]()
+    {
+        Text_writer writer(fd, lines);
+        for(long long k : keys)
+        {
+            writer.element(k);
+        }
+    }) << '\n';
+    std::cout << "bst_write_fd_lines," << keys.size() << ','
+              << seconds([&]() { tree.write(fd, lines); }) << '\n';
+    std::cout << "bst_write_fd_json," << keys.size() << ','
+              << seconds([&]() { tree.write(fd, json); }) << '\n';
+    ::close(fd);
+    return 0;
+}
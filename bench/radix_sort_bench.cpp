@@ -0,0 +1,92 @@
+// Benchmark of the radix path of Forward_list::sort against its merge
+// sort on the same keys
+//
+// Build with optimisation, for example
+//   g++ -std=c++17 -O2 -DNDEBUG radix_sort_bench.cpp -o radix_sort_bench
+// Usage
+//   ./radix_sort_bench [sizes...]
+// The default sizes are 1M and 10M elements.  100M elements need
+// several GB of memory, one list node of 16 bytes plus the allocator's
+// overhead per element, so that size has to be asked for explicitly.
+// The merge sort is reached by wrapping the keys in a type without a
+// Radix_key, which compares exactly like the key itself.
+// Prints one CSV line per key type, method and size.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../ass1/forward_list.hpp"
+
+template <typename Key>
+struct Boxed
+{
+    Key key;
+    bool operator<(const Boxed& other) const { return key < other.key; }
+};
+
+// builds a list of the keys, sorts it and returns the seconds
+// the sort took, or a negative number if the result is not sorted
+template <typename T, typename Key>
+double time_sort(const std::vector<Key>& keys)
+{
+    Forward_list<T> list;
+    for(Key k : keys)
+    {
+        list.push_front(T {k});
+    }
+    auto start = std::chrono::steady_clock::now();
+    list.sort();
+    auto stop = std::chrono::steady_clock::now();
+    T prev = list.front();
+    for(; !list.empty(); list.pop_front())
+    {
+        if(list.front() < prev)
+        {
+            return -1;
+        }
+        prev = list.front();
+    }
+    return std::chrono::duration<double>(stop - start).count();
+}
+
+template <typename Key>
+bool run(const char* type, std::size_t n)
+{
+    std::mt19937_64 mt(42);
+    std::vector<Key> keys(n);
+    for(Key& k : keys)
+    {
+        k = static_cast<Key>(mt());
+    }
+    double radix = time_sort<Key>(keys);
+    double merge = time_sort<Boxed<Key>>(keys);
+    std::cout << type << ",radix," << n << ',' << radix << '\n'
+              << type << ",merge," << n << ',' << merge << '\n';
+    return radix >= 0 && merge >= 0;
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::size_t> sizes;
+    for(int i = 1; i < argc; ++i)
+    {
+        sizes.push_back(std::strtoull(argv[i], nullptr, 10));
+    }
+    if(sizes.empty())
+    {
+        sizes = {1000000, 10000000};
+    }
+    std::cout << "key,method,elements,seconds\n";
+    for(std::size_t n : sizes)
+    {
+        if(!run<int>("int", n) || !run<std::uint64_t>("uint64_t", n))
+        {
+            std::cerr << "sort result is wrong\n";
+            return 1;
+        }
+    }
+    return 0;
+}
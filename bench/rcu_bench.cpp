@@ -0,0 +1,123 @@
+// Benchmark of a read-mostly workload: reader threads look keys up as
+// fast as they can while one writer changes the tree every millisecond.
+// Rcu_BST against BST behind a std::shared_mutex, where every lookup
+// takes the lock in shared mode and so writes the lock's cache line.
+//
+// Build with optimisation, for example
+//   g++ -std=c++17 -O2 -DNDEBUG -pthread rcu_bench.cpp -o rcu_bench
+// Usage
+//   ./rcu_bench [keys] [reader threads] [seconds]
+// Prints one CSV line per tree with the lookups per second of all
+// readers together.
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+#include "../ass2/bst.hpp"
+#include "../ass2/rcu_bst.hpp"
+
+// runs readers threads of lookup(thread, key) for seconds while
+// update(i) is called once a millisecond, returns lookups per second
+template <typename Lookup, typename Update>
+double run(unsigned readers, double seconds, int key_range, Lookup lookup, Update update)
+{
+    std::atomic<bool> done {false};
+    std::atomic<unsigned long long> lookups {0};
+    std::atomic<unsigned long long> hits {0};
+    std::vector<std::thread> threads;
+    for(unsigned t = 0; t < readers; ++t)
+    {
+        threads.emplace_back([&, t]()
+        {
+            std::mt19937 mt(t);
+            std::uniform_int_distribution<int> key(0, key_range - 1);
+            unsigned long long local = 0;
+            unsigned long long found = 0;
+            while(!done.load(std::memory_order_relaxed))
+            {
+                for(int i = 0; i < 256; ++i)
+                {
+                    found += lookup(t, key(mt));
+                }
+                local += 256;
+            }
+            lookups.fetch_add(local);
+            hits.fetch_add(found);
+        });
+    }
+    auto start = std::chrono::steady_clock::now();
+    auto stop = start + std::chrono::duration<double>(seconds);
+    for(int i = 0; std::chrono::steady_clock::now() < stop; ++i)
+    {
+        update(i);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    done.store(true);
+    for(std::thread& t : threads)
+    {
+        t.join();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << "hits " << hits.load() << '\n';
+    return lookups.load() / elapsed;
+}
+
+int main(int argc, char** argv)
+{
+    const int n = (argc > 1) ? std::atoi(argv[1]) : 1000000;
+    const unsigned readers = (argc > 2) ? std::atoi(argv[2])
+                                        : std::max(1u, std::thread::hardware_concurrency());
+    const double seconds = (argc > 3) ? std::atof(argv[3]) : 2.0;
+
+    std::mt19937 mt(42);
+    std::uniform_int_distribution<int> key(0, 2 * n - 1);
+    std::vector<int> keys(n);
+    for(int& k : keys)
+    {
+        k = key(mt);
+    }
+
+    std::cout << "tree,keys,readers,lookups_per_second\n";
+    {
+        BST<int> tree;
+        for(int k : keys)
+        {
+            tree.insert(k);
+        }
+        std::shared_mutex mutex;
+        double rate = run(readers, seconds, 2 * n,
+            [&](unsigned, int k)
+            {
+                std::shared_lock<std::shared_mutex> lock(mutex);
+                return tree.find(k) != nullptr;
+            },
+            [&](int i)
+            {
+                std::unique_lock<std::shared_mutex> lock(mutex);
+                tree.insert(2 * n + i);
+            });
+        std::cout << "BST+shared_mutex," << n << ',' << readers << ',' << rate << '\n';
+    }
+    {
+        Rcu_BST<int> tree(readers + 1);
+        for(int k : keys)
+        {
+            tree.insert(k);
+        }
+        std::vector<std::unique_ptr<Rcu_BST<int>::Reader>> handles;
+        for(unsigned t = 0; t < readers; ++t)
+        {
+            handles.emplace_back(new Rcu_BST<int>::Reader(tree));
+        }
+        double rate = run(readers, seconds, 2 * n,
+            [&](unsigned t, int k) { return handles[t]->contains(k); },
+            [&](int i) { tree.insert(2 * n + i); });
+        std::cout << "Rcu_BST," << n << ',' << readers << ',' << rate << '\n';
+    }
+    return 0;
+}
@@ -0,0 +1,76 @@
+// Benchmark of concurrent inserts: threads insert disjoint random keys
+// into one BST behind a mutex and into a Sharded_BST
+//
+// Build with optimisation, for example
+//   g++ -std=c++17 -O2 -DNDEBUG -pthread sharded_bench.cpp -o sharded_bench
+// Usage
+//   ./sharded_bench [keys] [threads] [shards]
+// Prints one CSV line per container with the inserts per second.
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include "../ass2/bst.hpp"
+#include "../ass2/sharded_bst.hpp"
+
+// each of threads threads calls insert on its share of keys,
+// returns the inserts per second
+template <typename Insert>
+double run(const std::vector<int>& keys, unsigned threads, Insert insert)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for(unsigned t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&, t]()
+        {
+            for(std::size_t i = t; i < keys.size(); i += threads)
+            {
+                insert(keys[i]);
+            }
+        });
+    }
+    for(std::thread& w : workers)
+    {
+        w.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return keys.size() / seconds;
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t n = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    const unsigned threads = (argc > 2) ? std::atoi(argv[2])
+                                        : std::max(1u, std::thread::hardware_concurrency());
+    const unsigned shards = (argc > 3) ? std::atoi(argv[3]) : 4 * threads;
+
+    std::mt19937 mt(42);
+    std::vector<int> keys(n);
+    for(int& k : keys)
+    {
+        k = static_cast<int>(mt() >> 1);
+    }
+
+    std::cout << "container,keys,threads,inserts_per_second\n";
+    {
+        BST<int> tree;
+        std::mutex mutex;
+        double rate = run(keys, threads, [&](int k)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tree.insert(k);
+        });
+        std::cout << "BST+mutex," << n << ',' << threads << ',' << rate << '\n';
+    }
+    {
+        Sharded_BST<int> tree(shards);
+        double rate = run(keys, threads, [&](int k) { tree.insert(k); });
+        std::cout << "Sharded_BST_" << shards << "," << n << ',' << threads << ',' << rate << '\n';
+    }
+    return 0;
+}
@@ -0,0 +1,67 @@
+// Benchmark of Small_forward_list against Forward_list and
+// std::forward_list on many short lists, the typical 1 to 16
+// element workload
+//
+// Build with optimisation, for example
+//   g++ -std=c++17 -O2 -DNDEBUG small_list_bench.cpp -o small_list_bench
+// Usage
+//   ./small_list_bench [lists per size]
+// For every list length, builds that many lists of random values,
+// sorts each one, copies it and destroys both.
+// Prints one CSV line per container and list length.
+
+#include <chrono>
+#include <cstdlib>
+#include <forward_list>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../ass1/forward_list.hpp"
+#include "../ass1/small_forward_list.hpp"
+
+// Runs the workload on lists of type List and returns the seconds taken
+// sum receives the sum of the fronts, so that nothing is optimised away
+template <typename List>
+double run(const std::vector<int>& values, unsigned lists, unsigned length, long long& sum)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::size_t next = 0;
+    for(unsigned i = 0; i < lists; ++i)
+    {
+        List list;
+        for(unsigned j = 0; j < length; ++j)
+        {
+            list.push_front(values[next++ % values.size()]);
+        }
+        list.sort();
+        List copy {list};
+        sum += copy.front();
+    }
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(stop - start).count();
+}
+
+int main(int argc, char** argv)
+{
+    const unsigned lists = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    std::mt19937 mt(42);
+    std::vector<int> values(1 << 16);
+    for(int& x : values)
+    {
+        x = static_cast<int>(mt());
+    }
+
+    long long sum = 0;
+    std::cout << "container,length,lists,seconds\n";
+    for(unsigned length = 1; length <= 16; ++length)
+    {
+        double small = run<Small_forward_list<int>>(values, lists, length, sum);
+        double plain = run<Forward_list<int>>(values, lists, length, sum);
+        double real = run<std::forward_list<int>>(values, lists, length, sum);
+        std::cout << "Small_forward_list<int>," << length << ',' << lists << ',' << small << '\n'
+                  << "Forward_list<int>," << length << ',' << lists << ',' << plain << '\n'
+                  << "std::forward_list<int>," << length << ',' << lists << ',' << real << '\n';
+    }
+    std::cerr << "checksum " << sum << '\n';
+    return 0;
+}
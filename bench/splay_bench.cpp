@@ -0,0 +1,102 @@
+// Benchmark of BST in splay mode against the plain BST, a perfectly
+// balanced BST and std::set on zipfian lookups, where a few hot keys
+// take most of the accesses
+//
+// Build with optimisation, for example
+//   g++ -std=c++17 -O2 -DNDEBUG splay_bench.cpp -o splay_bench
+// Usage
+//   ./splay_bench [keys] [lookups]
+// The keys are inserted in random order.  The balanced tree is the
+// same tree saved and loaded again, as load builds it balanced.
+// Prints one CSV line per tree and skew, with the time of the lookups
+// and the average number of nodes visited per lookup.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <set>
+#include <sstream>
+#include <vector>
+#include "../ass2/bst.hpp"
+#include "../common/workload.hpp"
+
+// runs the lookups and returns the seconds taken
+// contains(k) tells whether the tree holds k, found receives the number
+// of keys found, so that nothing is optimised away
+template <typename Contains>
+double run(Contains contains, const std::vector<int>& lookups, std::size_t& found)
+{
+    auto start = std::chrono::steady_clock::now();
+    for(int k : lookups)
+    {
+        found += contains(k);
+    }
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(stop - start).count();
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t n = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 100000;
+    const std::size_t m = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 2000000;
+
+    // distinct keys in random order
+    std::vector<int> keys = make_keys(Distribution::uniform, n, 42);
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    std::mt19937_64 mt(7);
+    std::shuffle(keys.begin(), keys.end(), mt);
+
+    std::cout << "tree,skew,keys,lookups,seconds,visits_per_lookup\n";
+    std::size_t found = 0;
+    for(double skew : {0.8, 0.99, 1.2})
+    {
+        // rank r of the distribution is the key at hot[r], a shuffle
+        // independent of the insertion order, so that the hot keys are
+        // neither the first keys inserted nor the smallest ones
+        std::vector<int> hot = keys;
+        std::shuffle(hot.begin(), hot.end(), mt);
+        Zipf_distribution zipf(hot.size(), skew);
+        std::vector<int> lookups(m);
+        for(int& k : lookups)
+        {
+            k = hot[zipf(mt)];
+        }
+
+        BST<int, Count_stats> plain;
+        BST<int, Count_stats> splay;
+        std::set<int> real;
+        splay.set_splay(true);
+        for(int k : keys)
+        {
+            plain.insert(k);
+            splay.insert(k);
+            real.insert(k);
+        }
+        BST<int, Count_stats> balanced;
+        std::stringstream buffer;
+        plain.save(buffer);
+        balanced.load(buffer);
+
+        BST<int, Count_stats>* trees[] = {&plain, &balanced, &splay};
+        const char* names[] = {"plain", "balanced", "splay"};
+        for(int t = 0; t < 3; ++t)
+        {
+            trees[t]->reset_stats();
+            BST<int, Count_stats>& tree = *trees[t];
+            double seconds = run([&tree](int k) { return tree.find(k) != nullptr; },
+                                 lookups, found);
+            std::cout << names[t] << ',' << skew << ',' << keys.size() << ',' << m << ','
+                      << seconds << ','
+                      << static_cast<double>(tree.stats().nodes_visited) / m << '\n';
+        }
+        double seconds = run([&real](int k) { return real.count(k) != 0; },
+                             lookups, found);
+        std::cout << "std::set," << skew << ',' << keys.size() << ',' << m << ','
+                  << seconds << ",\n";
+    }
+    std::cerr << "found " << found << '\n';
+    return 0;
+}
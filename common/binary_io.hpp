@@ -0,0 +1,278 @@
+#ifndef DSA_BINARY_IO_HPP
+#define DSA_BINARY_IO_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <unistd.h>
+
+// Buffered binary input and output shared by the containers'
+// save and load functions.
+// Both classes work either on a std::ostream / std::istream, whose
+// stream buffer batches the many small reads and writes, or on a POSIX
+// file descriptor, where data is moved through our own 64 KiB buffer so
+// that writing or reading one small key is just a memcpy.
+// Values are stored in the byte order of the machine that wrote them.
+
+// bytes of the buffer each writer or reader on a file descriptor holds
+constexpr std::size_t binary_buffer_size = 1 << 16;
+
+class Binary_writer
+{
+public:
+    explicit Binary_writer(std::ostream& out) : out_(&out) {}
+    explicit Binary_writer(int fd) : fd_(fd) { buffer_.reserve(binary_buffer_size); }
+
+    // Anything still buffered is written out by the destructor,
+    // call flush() first to find out whether that succeeded
+    ~Binary_writer() { flush(); }
+
+    Binary_writer(const Binary_writer&) = delete;
+    Binary_writer& operator=(const Binary_writer&) = delete;
+
+    bool write(const void* data, std::size_t bytes)
+    {
+        const char* p = static_cast<const char*>(data);
+        if(out_ != nullptr)
+        {
+            // the stream buffer already batches small writes
+            good_ = good_ && static_cast<bool>(out_->write(p, bytes));
+            return good_;
+        }
+        if(buffer_.size() + bytes > binary_buffer_size)
+        {
+            if(!flush())
+            {
+                return false;
+            }
+            if(bytes >= binary_buffer_size)
+            {
+                // large blocks bypass the buffer
+                return write_fd(p, bytes);
+            }
+        }
+        buffer_.insert(buffer_.end(), p, p + bytes);
+        return true;
+    }
+
+    bool flush()
+    {
+        if(out_ != nullptr)
+        {
+            good_ = good_ && static_cast<bool>(out_->flush());
+        }
+        else if(!buffer_.empty())
+        {
+            write_fd(buffer_.data(), buffer_.size());
+            buffer_.clear();
+        }
+        return good_;
+    }
+
+    bool good() const { return good_; }
+
+private:
+    bool write_fd(const char* data, std::size_t bytes)
+    {
+        while(good_ && bytes > 0)
+        {
+            ssize_t written = ::write(fd_, data, bytes);
+            if(written <= 0)
+            {
+                good_ = false;
+            }
+            else
+            {
+                data += written;
+                bytes -= written;
+            }
+        }
+        return good_;
+    }
+
+    std::ostream* out_ = nullptr;
+    int fd_ = -1;
+    bool good_ = true;
+    std::vector<char> buffer_;
+};
+
+class Binary_reader
+{
+public:
+    explicit Binary_reader(std::istream& in) : in_(&in) {}
+    explicit Binary_reader(int fd) : fd_(fd), buffer_(binary_buffer_size) {}
+
+    // Bytes read ahead from a file descriptor but not consumed are
+    // handed back with lseek, so that whatever follows in the file
+    // can be read next.  This is not possible on pipes and sockets.
+    ~Binary_reader()
+    {
+        if(in_ == nullptr && pos_ < end_)
+        {
+            ::lseek(fd_, -static_cast<off_t>(end_ - pos_), SEEK_CUR);
+        }
+    }
+
+    Binary_reader(const Binary_reader&) = delete;
+    Binary_reader& operator=(const Binary_reader&) = delete;
+
+    // Reads exactly bytes bytes, returns false if the input ends first
+    bool read(void* data, std::size_t bytes)
+    {
+        char* p = static_cast<char*>(data);
+        if(in_ != nullptr)
+        {
+            // never read ahead of what was asked for, so that the
+            // stream is left just after the container's data
+            return static_cast<bool>(in_->read(p, bytes));
+        }
+        while(bytes > 0)
+        {
+            if(pos_ == end_ && !refill())
+            {
+                return false;
+            }
+            std::size_t chunk = std::min(bytes, end_ - pos_);
+            std::memcpy(p, buffer_.data() + pos_, chunk);
+            pos_ += chunk;
+            p += chunk;
+            bytes -= chunk;
+        }
+        return true;
+    }
+
+    // True once the input has no more bytes to give
+    bool at_end()
+    {
+        if(in_ != nullptr)
+        {
+            return in_->peek() == std::istream::traits_type::eof();
+        }
+        return pos_ == end_ && !refill();
+    }
+
+private:
+    bool refill()
+    {
+        ssize_t got = ::read(fd_, buffer_.data(), buffer_.size());
+        pos_ = 0;
+        end_ = (got > 0) ? static_cast<std::size_t>(got) : 0;
+        return end_ > 0;
+    }
+
+    std::istream* in_ = nullptr;
+    int fd_ = -1;
+    std::vector<char> buffer_;
+    std::size_t pos_ = 0;
+    std::size_t end_ = 0;
+};
+
+// Binary_codec<T> describes how a single key is stored.
+// Trivially copyable types are stored as their raw bytes,
+// std::string as a 64-bit length followed by its characters.
+// The tag identifies the key type in the file header so that
+// loading a file into a container of another type fails cleanly.
+template <typename T>
+struct Binary_codec
+{
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Binary_codec needs a trivially copyable type or a specialisation");
+
+    static constexpr std::uint32_t tag =
+        ((std::is_integral<T>::value && std::is_signed<T>::value) ? 1u :
+         std::is_integral<T>::value ? 2u :
+         std::is_floating_point<T>::value ? 3u : 4u) << 16 | sizeof(T);
+
+    static bool write(Binary_writer& out, const T& value)
+    {
+        return out.write(&value, sizeof(T));
+    }
+
+    static bool read(Binary_reader& in, T& value)
+    {
+        return in.read(&value, sizeof(T));
+    }
+};
+
+template <>
+struct Binary_codec<std::string>
+{
+    static constexpr std::uint32_t tag = 5u << 16 | sizeof(char);
+
+    static bool write(Binary_writer& out, const std::string& value)
+    {
+        std::uint64_t length = value.size();
+        return out.write(&length, sizeof(length)) &&
+               out.write(value.data(), value.size());
+    }
+
+    // The length comes from the file and may be corrupt, so the string
+    // only grows by what has actually been read, a chunk at a time, and
+    // a length past the end of the input fails instead of allocating it.
+    static bool read(Binary_reader& in, std::string& value)
+    {
+        std::uint64_t length = 0;
+        if(!in.read(&length, sizeof(length)) || length > value.max_size())
+        {
+            return false;
+        }
+        value.clear();
+        while(value.size() < length)
+        {
+            std::size_t done = value.size();
+            std::size_t chunk = std::min<std::uint64_t>(length - done, chunk_size);
+            value.resize(done + chunk);
+            if(!in.read(&value[done], chunk))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    static constexpr std::size_t chunk_size = 1 << 16;
+};
+
+// Every saved container starts with this header:
+// a 4 character magic naming the container, the key type tag
+// and the number of keys that follow.
+template <typename T>
+bool write_binary_header(Binary_writer& out, const char* magic, std::uint64_t size)
+{
+    std::uint32_t tag = Binary_codec<T>::tag;
+    return out.write(magic, 4) &&
+           out.write(&tag, sizeof(tag)) &&
+           out.write(&size, sizeof(size));
+}
+
+// Reads a header with either of two magics, for a container saved in
+// two layouts, and sets second if it is second_magic
+template <typename T>
+bool read_binary_header(Binary_reader& in, const char* magic, const char* second_magic,
+                        bool& second, std::uint64_t& size)
+{
+    char file_magic[4];
+    std::uint32_t tag = 0;
+    if(!in.read(file_magic, 4) || !in.read(&tag, sizeof(tag)) ||
+       !in.read(&size, sizeof(size)))
+    {
+        return false;
+    }
+    second = std::memcmp(file_magic, second_magic, 4) == 0;
+    return (second || std::memcmp(file_magic, magic, 4) == 0) && tag == Binary_codec<T>::tag;
+}
+
+template <typename T>
+bool read_binary_header(Binary_reader& in, const char* magic, std::uint64_t& size)
+{
+    bool second = false;
+    return read_binary_header<T>(in, magic, magic, second, size);
+}
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef DSA_COMPLEXITY_HPP
+#define DSA_COMPLEXITY_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+// Empirical growth curves for the complexity regression tests.
+//
+// If the time of a workload of size n grows like n^e, then log(time)
+// is a straight line in log(n) with slope e.  growth_exponent fits that
+// line by least squares.  n log n work gives an exponent slightly above
+// 1, quadratic work an exponent near 2, so a test can flag a change
+// that turns an O(log n) operation into an O(n) one.
+
+inline double growth_exponent(const std::vector<double>& sizes,
+                              const std::vector<double>& seconds)
+{
+    const std::size_t m = std::min(sizes.size(), seconds.size());
+    double sum_x = 0, sum_y = 0, sum_xx = 0, sum_xy = 0;
+    for(std::size_t i = 0; i < m; ++i)
+    {
+        double x = std::log(sizes[i]);
+        double y = std::log(std::max(seconds[i], 1e-9));
+        sum_x += x;
+        sum_y += y;
+        sum_xx += x * x;
+        sum_xy += x * y;
+    }
+    double denominator = m * sum_xx - sum_x * sum_x;
+    if(m < 2 || denominator == 0)
+    {
+        return 0;
+    }
+    return (m * sum_xy - sum_x * sum_y) / denominator;
+}
+
+// Times run(n) for every n in sizes, keeping the fastest of trials
+// runs to filter out noise, and returns the fitted growth exponent
+template <typename Run>
+double measure_growth(const std::vector<double>& sizes, Run run, int trials = 3)
+{
+    std::vector<double> seconds;
+    for(double n : sizes)
+    {
+        double best = 1e300;
+        for(int t = 0; t < trials; ++t)
+        {
+            auto start = std::chrono::steady_clock::now();
+            run(static_cast<std::size_t>(n));
+            auto stop = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double>(stop - start).count());
+        }
+        seconds.push_back(best);
+    }
+    return growth_exponent(sizes, seconds);
+}
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef DSA_CONTAINER_STATS_HPP
+#define DSA_CONTAINER_STATS_HPP
+
+#include <cstdint>
+
+// Statistics policies for Forward_list and BST.
+//
+// The containers take the policy as their last template argument and
+// call it on their hot paths.  The default, No_stats, does nothing and
+// takes no space, so Forward_list<T> and BST<T> compile to exactly the
+// same code as without instrumentation.  With Count_stats every container
+// instance keeps its own counters, read with stats() and cleared with
+// reset_stats():
+//
+//     BST<int, Count_stats> tree;
+//     ...
+//     Container_stats s = tree.stats();
+//     tree.reset_stats();
+
+// The counters of one container at one point in time
+struct Container_stats
+{
+    // key comparisons, where deciding between less, equal and
+    // greater at one node of a BST counts as one
+    std::uint64_t comparisons = 0;
+    // nodes stepped through while searching or walking the structure
+    std::uint64_t nodes_visited = 0;
+    // nodes allocated and freed
+    std::uint64_t allocations = 0;
+    std::uint64_t frees = 0;
+    // BST only: nodes whose height fix_height recomputed, and rotations
+    std::uint64_t fix_height_steps = 0;
+    std::uint64_t rotations = 0;
+    // Forward_list only: next pointers rewritten by merge, split and sort
+    std::uint64_t nodes_relinked = 0;
+};
+
+struct No_stats
+{
+    static constexpr bool enabled = false;
+
+    void comparison(std::uint64_t = 1) {}
+    void visit(std::uint64_t = 1) {}
+    void allocation(std::uint64_t = 1) {}
+    void free(std::uint64_t = 1) {}
+    void fix_height_step(std::uint64_t = 1) {}
+    void rotation(std::uint64_t = 1) {}
+    void relink(std::uint64_t = 1) {}
+
+    Container_stats snapshot() const { return Container_stats(); }
+    void reset() {}
+    void add(const No_stats&) {}
+};
+
+struct Count_stats
+{
+    static constexpr bool enabled = true;
+
+    void comparison(std::uint64_t n = 1) { counters_.comparisons += n; }
+    void visit(std::uint64_t n = 1) { counters_.nodes_visited += n; }
+    void allocation(std::uint64_t n = 1) { counters_.allocations += n; }
+    void free(std::uint64_t n = 1) { counters_.frees += n; }
+    void fix_height_step(std::uint64_t n = 1) { counters_.fix_height_steps += n; }
+    void rotation(std::uint64_t n = 1) { counters_.rotations += n; }
+    void relink(std::uint64_t n = 1) { counters_.nodes_relinked += n; }
+
+    Container_stats snapshot() const { return counters_; }
+    void reset() { counters_ = Container_stats(); }
+
+    // adds the counters of other, for a container taking over the work
+    // of a temporary it used
+    void add(const Count_stats& other)
+    {
+        counters_.comparisons += other.counters_.comparisons;
+        counters_.nodes_visited += other.counters_.nodes_visited;
+        counters_.allocations += other.counters_.allocations;
+        counters_.frees += other.counters_.frees;
+        counters_.fix_height_steps += other.counters_.fix_height_steps;
+        counters_.rotations += other.counters_.rotations;
+        counters_.nodes_relinked += other.counters_.nodes_relinked;
+    }
+
+private:
+    Container_stats counters_;
+};
+
+#endif
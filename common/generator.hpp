@@ -0,0 +1,253 @@
+#ifndef DSA_GENERATOR_HPP
+#define DSA_GENERATOR_HPP
+
+// Lazy generators over the containers, built on C++20 coroutines.
+//
+// A Generator<T> produces its values one at a time, only when the
+// consumer asks for the next one, so a pipeline that stops early never
+// does the work for the values it did not look at:
+//
+//     BST<int> tree;
+//     ...
+//     for(int k : taken(filtered(tree.in_order(), is_even), 100))
+//     {
+//         ...
+//     }
+//
+// walks the tree only as far as the hundredth even key and allocates
+// no vector on the way.  The stages filtered, mapped, taken and merged
+// take their sources by value and can be nested freely.
+//
+// The values are handed out by const reference and stay valid until
+// the generator is advanced.  A generator over a container must not
+// outlive it, and the container must not be changed while it is used.
+//
+// Everything here needs C++20.  With an older standard this header is
+// empty and DSA_HAS_GENERATOR is not defined, so the containers leave
+// out their generator functions and the rest still builds as C++17.
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#define DSA_HAS_GENERATOR 1
+#endif
+#endif
+
+#ifdef DSA_HAS_GENERATOR
+
+#include <algorithm>
+#include <coroutine>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+template <typename T>
+class Generator
+{
+public:
+    struct promise_type
+    {
+        // the value last yielded, which lives in the suspended
+        // coroutine's frame or in the container it walks
+        const T* value = nullptr;
+
+        Generator get_return_object()
+        {
+            return Generator(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        // the body only starts running when the first value is asked for
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+
+        // a temporary yielded lives until the coroutine is resumed,
+        // so holding its address is safe
+        std::suspend_always yield_value(const T& v) noexcept
+        {
+            value = std::addressof(v);
+            return {};
+        }
+
+        void return_void() {}
+        void unhandled_exception() { throw; }
+
+        // generators only yield, they never wait on anything
+        template <typename U>
+        std::suspend_never await_transform(U&&) = delete;
+    };
+
+    typedef std::coroutine_handle<promise_type> handle_type;
+
+    // An input iterator, which resumes the coroutine on ++
+    class iterator
+    {
+    public:
+        typedef std::input_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const T* pointer;
+        typedef const T& reference;
+
+        iterator() {}
+        explicit iterator(handle_type h) : h_(h) {}
+
+        const T& operator*() const { return *h_.promise().value; }
+        const T* operator->() const { return h_.promise().value; }
+
+        iterator& operator++()
+        {
+            h_.resume();
+            return *this;
+        }
+        void operator++(int) { ++*this; }
+
+        bool operator==(std::default_sentinel_t) const { return h_ == nullptr || h_.done(); }
+
+    private:
+        handle_type h_ = nullptr;
+    };
+
+    Generator() {}
+    Generator(const Generator&) = delete;
+    Generator& operator=(const Generator&) = delete;
+
+    Generator(Generator&& other) noexcept : h_(std::exchange(other.h_, nullptr)) {}
+
+    Generator& operator=(Generator&& other) noexcept
+    {
+        if(this != &other)
+        {
+            destroy();
+            h_ = std::exchange(other.h_, nullptr);
+        }
+        return *this;
+    }
+
+    ~Generator() { destroy(); }
+
+    // runs the coroutine up to its first value
+    // begin may only be called once per generator
+    iterator begin()
+    {
+        if(h_ != nullptr)
+        {
+            h_.resume();
+        }
+        return iterator(h_);
+    }
+
+    std::default_sentinel_t end() const { return std::default_sentinel; }
+
+private:
+    explicit Generator(handle_type h) : h_(h) {}
+
+    void destroy()
+    {
+        if(h_ != nullptr)
+        {
+            h_.destroy();
+            h_ = nullptr;
+        }
+    }
+
+    handle_type h_ = nullptr;
+};
+
+// the values of source for which pred is true
+template <typename T, typename Pred>
+Generator<T> filtered(Generator<T> source, Pred pred)
+{
+    for(const T& value : source)
+    {
+        if(pred(value))
+        {
+            co_yield value;
+        }
+    }
+}
+
+// fn applied to each value of source
+template <typename T, typename Fn>
+Generator<std::decay_t<std::invoke_result_t<Fn&, const T&>>> mapped(Generator<T> source, Fn fn)
+{
+    for(const T& value : source)
+    {
+        co_yield fn(value);
+    }
+}
+
+// the first n values of source
+// source is not resumed again once the n-th value has been handed out
+template <typename T>
+Generator<T> taken(Generator<T> source, std::size_t n)
+{
+    if(n == 0)
+    {
+        co_return;
+    }
+    for(const T& value : source)
+    {
+        co_yield value;
+        if(--n == 0)
+        {
+            co_return;
+        }
+    }
+}
+
+// the values of sorted sources merged into one sorted sequence
+// A binary heap of the sources' current values picks the next one in
+// O(log k) comparisons for k sources.  Equal values come out in the
+// order of their sources in the vector.
+template <typename T>
+Generator<T> merged(std::vector<Generator<T>> sources)
+{
+    struct Head
+    {
+        typename Generator<T>::iterator it;
+        std::size_t source;
+    };
+    // std heaps keep the largest element on top, so the
+    // comparison is reversed to have the smallest value there
+    auto later = [](const Head& a, const Head& b)
+    {
+        if(*b.it < *a.it)
+        {
+            return true;
+        }
+        return !(*a.it < *b.it) && a.source > b.source;
+    };
+
+    std::vector<Head> heads;
+    heads.reserve(sources.size());
+    for(std::size_t i = 0; i < sources.size(); ++i)
+    {
+        typename Generator<T>::iterator it = sources[i].begin();
+        if(it != std::default_sentinel)
+        {
+            heads.push_back(Head {it, i});
+        }
+    }
+    std::make_heap(heads.begin(), heads.end(), later);
+
+    while(!heads.empty())
+    {
+        std::pop_heap(heads.begin(), heads.end(), later);
+        co_yield *heads.back().it;
+        ++heads.back().it;
+        if(heads.back().it == std::default_sentinel)
+        {
+            heads.pop_back();
+        }
+        else
+        {
+            std::push_heap(heads.begin(), heads.end(), later);
+        }
+    }
+}
+
+#endif
+
+#endif
@@ -0,0 +1,152 @@
+#ifndef DSA_MEMORY_USAGE_HPP
+#define DSA_MEMORY_USAGE_HPP
+
+#include <cstddef>
+#include <string>
+
+// Memory footprint reports for Forward_list and BST.
+//
+// memory_usage() on a container splits the bytes it holds into
+//   structural  links, heights, padding and the container object itself
+//   payload     the keys stored inside the nodes
+//   heap payload memory the keys own elsewhere, e.g. long std::strings
+//   allocator overhead  what malloc adds to every allocation
+// The allocator overhead is an estimate after glibc's malloc, which
+// puts a size_t header in front of each block and rounds the whole up
+// to a multiple of 16 bytes, with a minimum of 32.  Other allocators
+// differ in detail but not by much for the node sized blocks here.
+//
+//     Memory_usage m = tree.memory_usage();
+//     if(!m.within(budget)) ...
+
+// The estimated number of bytes malloc takes for a request of bytes
+inline std::size_t allocation_size(std::size_t bytes)
+{
+    const std::size_t align = 2 * sizeof(std::size_t);
+    std::size_t chunk = (bytes + sizeof(std::size_t) + align - 1) / align * align;
+    return chunk < 2 * align ? 2 * align : chunk;
+}
+
+// Heap_usage<T> tells memory_usage how many bytes a key owns outside
+// its node.  enabled is false for types that own nothing, which lets
+// the containers report in O(1) instead of visiting every key.
+// Specialise it for key types that own heap memory.
+template <typename T>
+struct Heap_usage
+{
+    static constexpr bool enabled = false;
+    static std::size_t bytes(const T&) { return 0; }
+};
+
+template <>
+struct Heap_usage<std::string>
+{
+    static constexpr bool enabled = true;
+
+    // short strings live inside the object itself, longer
+    // ones in a heap block of capacity plus the terminator
+    static std::size_t bytes(const std::string& s)
+    {
+        static const std::size_t inline_capacity = std::string().capacity();
+        return s.capacity() > inline_capacity ? s.capacity() + 1 : 0;
+    }
+};
+
+// How the bytes of one node are spent
+struct Node_layout
+{
+    // sizeof the node
+    std::size_t node_bytes = 0;
+    // the key stored in it
+    std::size_t key_bytes = 0;
+    // its pointers to other nodes
+    std::size_t link_bytes = 0;
+    // any other fields, such as a height
+    std::size_t other_bytes = 0;
+    // what the compiler adds for alignment
+    std::size_t padding_bytes = 0;
+    // the estimated block malloc hands out for it
+    std::size_t allocation_bytes = 0;
+};
+
+struct Memory_usage
+{
+    std::size_t nodes = 0;
+    Node_layout node;
+    // the container object and anything it allocates besides nodes
+    std::size_t container_bytes = 0;
+    // links, other fields and padding of all nodes, plus container_bytes
+    std::size_t structural_bytes = 0;
+    // the keys inside the nodes
+    std::size_t payload_bytes = 0;
+    // memory the keys own outside the nodes
+    std::size_t heap_payload_bytes = 0;
+    // estimated malloc headers and rounding, for the nodes and the
+    // keys' own heap blocks
+    std::size_t allocator_overhead_bytes = 0;
+
+    std::size_t total() const
+    {
+        return structural_bytes + payload_bytes + heap_payload_bytes + allocator_overhead_bytes;
+    }
+
+    // the bytes each key costs beyond its own, 0 for an empty container
+    double overhead_per_node() const
+    {
+        if(nodes == 0)
+        {
+            return 0.0;
+        }
+        return static_cast<double>(total() - payload_bytes - heap_payload_bytes) / nodes;
+    }
+
+    bool within(std::size_t budget) const
+    {
+        return total() <= budget;
+    }
+};
+
+// The report for nodes nodes of type Node holding a T each, with
+// link_bytes of pointers and other_bytes of other fields per node.
+// The caller adds the container bytes and the keys' heap memory.
+template <typename Node, typename T>
+Memory_usage node_memory_usage(std::size_t nodes, std::size_t link_bytes, std::size_t other_bytes)
+{
+    Memory_usage m;
+    m.nodes = nodes;
+    m.node.node_bytes = sizeof(Node);
+    m.node.key_bytes = sizeof(T);
+    m.node.link_bytes = link_bytes;
+    m.node.other_bytes = other_bytes;
+    m.node.padding_bytes = sizeof(Node) - sizeof(T) - link_bytes - other_bytes;
+    m.node.allocation_bytes = allocation_size(sizeof(Node));
+    m.structural_bytes = nodes * (sizeof(Node) - sizeof(T));
+    m.payload_bytes = nodes * sizeof(T);
+    m.allocator_overhead_bytes = nodes * (m.node.allocation_bytes - sizeof(Node));
+    return m;
+}
+
+// adds the heap memory of one key to m
+template <typename T>
+void add_heap_usage(Memory_usage& m, const T& key)
+{
+    std::size_t bytes = Heap_usage<T>::bytes(key);
+    if(bytes > 0)
+    {
+        m.heap_payload_bytes += bytes;
+        m.allocator_overhead_bytes += allocation_size(bytes) - bytes;
+    }
+}
+
+// adds the container object, and bytes it allocated in one block, to m
+inline void add_container_bytes(Memory_usage& m, std::size_t object_bytes, std::size_t block_bytes = 0)
+{
+    m.container_bytes += object_bytes + block_bytes;
+    m.structural_bytes += object_bytes + block_bytes;
+    if(block_bytes > 0)
+    {
+        m.allocator_overhead_bytes += allocation_size(block_bytes) - block_bytes;
+    }
+}
+
+#endif
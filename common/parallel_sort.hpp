@@ -0,0 +1,69 @@
+#ifndef DSA_PARALLEL_SORT_HPP
+#define DSA_PARALLEL_SORT_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Stable sort of [first, last) using up to threads threads.
+// The range is cut into one block per thread, each block is sorted
+// with std::stable_sort on its own thread, and neighbouring blocks are
+// then merged pairwise with std::inplace_merge, in rounds whose merges
+// also run in parallel.  Both steps are stable, so equal elements keep
+// their order.  Blocks are never smaller than min_block elements, as
+// starting a thread costs more than sorting a few thousand elements.
+template <typename RandomIt, typename Less>
+void parallel_stable_sort(RandomIt first, RandomIt last, Less less, unsigned threads,
+                          std::size_t min_block = 1 << 14)
+{
+    const std::size_t n = last - first;
+    std::size_t blocks = std::min<std::size_t>(std::max(threads, 1u),
+                                               std::max<std::size_t>(n / min_block, 1));
+    if(blocks <= 1)
+    {
+        std::stable_sort(first, last, less);
+        return;
+    }
+
+    std::vector<RandomIt> bounds(blocks + 1);
+    for(std::size_t i = 0; i <= blocks; ++i)
+    {
+        bounds[i] = first + n * i / blocks;
+    }
+
+    std::vector<std::thread> workers;
+    for(std::size_t i = 1; i < blocks; ++i)
+    {
+        workers.emplace_back([&bounds, &less, i]()
+        {
+            std::stable_sort(bounds[i], bounds[i + 1], less);
+        });
+    }
+    std::stable_sort(bounds[0], bounds[1], less);
+    for(std::thread& worker : workers)
+    {
+        worker.join();
+    }
+
+    for(std::size_t width = 1; width < blocks; width *= 2)
+    {
+        workers.clear();
+        for(std::size_t i = 0; i + width < blocks; i += 2 * width)
+        {
+            RandomIt begin = bounds[i];
+            RandomIt middle = bounds[i + width];
+            RandomIt end = bounds[std::min(i + 2 * width, blocks)];
+            workers.emplace_back([begin, middle, end, &less]()
+            {
+                std::inplace_merge(begin, middle, end, less);
+            });
+        }
+        for(std::thread& worker : workers)
+        {
+            worker.join();
+        }
+    }
+}
+
+#endif
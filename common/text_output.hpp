@@ -0,0 +1,354 @@
+#ifndef DSA_TEXT_OUTPUT_HPP
+#define DSA_TEXT_OUTPUT_HPP
+
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include "binary_io.hpp"
+
+// Buffered text output shared by the containers' write, display and
+// print functions.
+// Text_writer formats every element into one large buffer, numbers
+// with std::to_chars rather than an ostream, and hands the buffer to
+// the stream or file descriptor only when it is full and at the end,
+// through Binary_writer.  Nothing is flushed per element.
+
+// How a sequence of elements is laid out
+//   plain  the elements on one line, split by Text_options::separator
+//   lines  one element per line
+//   csv    a header line and then one element per line, with strings
+//          quoted where CSV needs it
+//   json   one JSON array, with strings quoted and escaped
+enum class Text_format
+{
+    plain,
+    lines,
+    csv,
+    json
+};
+
+struct Text_options
+{
+    Text_format format = Text_format::plain;
+    // between two elements in the plain format
+    std::string separator = " ";
+    // the first line of the csv format, none if empty
+    std::string csv_header = "key";
+};
+
+class Text_writer
+{
+public:
+    explicit Text_writer(std::ostream& out, const Text_options& options = Text_options())
+        : sink_(out), options_(options), buffer_(new char[capacity]) {}
+
+    explicit Text_writer(int fd, const Text_options& options = Text_options())
+        : sink_(fd), options_(options), buffer_(new char[capacity]) {}
+
+    // Finishes the sequence and writes out what is still buffered,
+    // call finish() first to find out whether that succeeded
+    ~Text_writer() { finish(); }
+
+    Text_writer(const Text_writer&) = delete;
+    Text_writer& operator=(const Text_writer&) = delete;
+
+    // opens the sequence: the csv header or the json bracket
+    void begin()
+    {
+        if(begun_)
+        {
+            return;
+        }
+        begun_ = true;
+        if(options_.format == Text_format::csv && !options_.csv_header.empty())
+        {
+            put(options_.csv_header);
+            put('\n');
+        }
+        else if(options_.format == Text_format::json)
+        {
+            put('[');
+        }
+    }
+
+    // appends one element of the sequence in the chosen format
+    template <typename T>
+    bool element(const T& x)
+    {
+        begin();
+        switch(options_.format)
+        {
+            case Text_format::plain:
+                if(elements_ > 0)
+                {
+                    put(options_.separator);
+                }
+                append(x);
+                break;
+            case Text_format::lines:
+                append(x);
+                put('\n');
+                break;
+            case Text_format::csv:
+                csv_value(x);
+                put('\n');
+                break;
+            case Text_format::json:
+                if(elements_ > 0)
+                {
+                    put(',');
+                }
+                json_value(x);
+                break;
+        }
+        ++elements_;
+        return spill();
+    }
+
+    // appends x as it is, without separator or quoting
+    template <typename T>
+    bool value(const T& x)
+    {
+        append(x);
+        return spill();
+    }
+
+    // appends raw text
+    bool text(const char* s)
+    {
+        put(s, std::strlen(s));
+        return spill();
+    }
+
+    // closes the sequence, if it was opened, and writes out the buffer
+    // Calling it again does nothing more.
+    bool finish()
+    {
+        if(begun_ && !finished_)
+        {
+            finished_ = true;
+            if(options_.format == Text_format::plain)
+            {
+                put('\n');
+            }
+            else if(options_.format == Text_format::json)
+            {
+                put("]\n", 2);
+            }
+        }
+        return flush();
+    }
+
+    bool flush()
+    {
+        hand_over();
+        return sink_.flush();
+    }
+
+    bool good() const { return sink_.good(); }
+
+private:
+    // The buffer is handed over once it holds buffer_size bytes, which
+    // is also the size at which Binary_writer writes it to a file
+    // descriptor directly instead of copying it into its own buffer.
+    // The slack above that leaves room for any number, so numbers are
+    // converted by std::to_chars straight into the buffer.
+    static constexpr std::size_t buffer_size = 1 << 16;
+    static constexpr std::size_t slack = 256;
+    static constexpr std::size_t capacity = buffer_size + slack;
+
+    void hand_over()
+    {
+        if(used_ > 0)
+        {
+            sink_.write(buffer_.get(), used_);
+            used_ = 0;
+        }
+    }
+
+    bool spill()
+    {
+        if(used_ >= buffer_size)
+        {
+            hand_over();
+        }
+        return sink_.good();
+    }
+
+    void put(char c)
+    {
+        if(used_ == capacity)
+        {
+            hand_over();
+        }
+        buffer_[used_++] = c;
+    }
+
+    void put(const char* p, std::size_t n)
+    {
+        if(used_ + n > capacity)
+        {
+            hand_over();
+            if(n > capacity)
+            {
+                sink_.write(p, n);
+                return;
+            }
+        }
+        std::memcpy(buffer_.get() + used_, p, n);
+        used_ += n;
+    }
+
+    void put(const std::string& s)
+    {
+        put(s.data(), s.size());
+    }
+
+    // the text of a value that is not a number: the string itself,
+    // or the character or what its operator<< prints, kept in scratch_
+    template <typename T>
+    const std::string& as_text(const T& x)
+    {
+        if constexpr(std::is_convertible<const T&, const std::string&>::value)
+        {
+            return x;
+        }
+        else if constexpr(std::is_same<T, char>::value)
+        {
+            scratch_.assign(1, x);
+            return scratch_;
+        }
+        else
+        {
+            std::ostringstream text;
+            text << x;
+            scratch_ = text.str();
+            return scratch_;
+        }
+    }
+
+    // x in its plain form, numbers through std::to_chars
+    template <typename T>
+    void append(const T& x)
+    {
+        if constexpr(std::is_same<T, bool>::value)
+        {
+            put(x ? '1' : '0');
+        }
+        else if constexpr(std::is_same<T, char>::value)
+        {
+            put(x);
+        }
+        else if constexpr(std::is_arithmetic<T>::value)
+        {
+            if(capacity - used_ < slack)
+            {
+                hand_over();
+            }
+            char* first = buffer_.get() + used_;
+            std::to_chars_result result = std::to_chars(first, buffer_.get() + capacity, x);
+            used_ += result.ptr - first;
+        }
+        else
+        {
+            put(as_text(x));
+        }
+    }
+
+    template <typename T>
+    void csv_value(const T& x)
+    {
+        // a char is text, and ',' or '"' need quoting like in a string
+        if constexpr(std::is_arithmetic<T>::value && !std::is_same<T, char>::value)
+        {
+            append(x);
+        }
+        else
+        {
+            // fields holding a separator, quote or line break are
+            // quoted, with quotes inside doubled
+            const std::string& field = as_text(x);
+            if(field.find_first_of(",\"\r\n") == std::string::npos)
+            {
+                put(field);
+                return;
+            }
+            put('"');
+            for(char c : field)
+            {
+                if(c == '"')
+                {
+                    put('"');
+                }
+                put(c);
+            }
+            put('"');
+        }
+    }
+
+    template <typename T>
+    void json_value(const T& x)
+    {
+        if constexpr(std::is_same<T, bool>::value)
+        {
+            put(x ? "true" : "false", x ? 4 : 5);
+        }
+        else if constexpr(std::is_floating_point<T>::value)
+        {
+            // JSON has no infinities or NaN
+            if(std::isfinite(x))
+            {
+                append(x);
+            }
+            else
+            {
+                put("null", 4);
+            }
+        }
+        else if constexpr(std::is_arithmetic<T>::value && !std::is_same<T, char>::value)
+        {
+            append(x);
+        }
+        else
+        {
+            const std::string& field = as_text(x);
+            put('"');
+            for(char c : field)
+            {
+                if(c == '"' || c == '\\')
+                {
+                    put('\\');
+                    put(c);
+                }
+                else if(static_cast<unsigned char>(c) < 0x20)
+                {
+                    const char* hex = "0123456789abcdef";
+                    put("\\u00", 4);
+                    put(hex[(c >> 4) & 0xf]);
+                    put(hex[c & 0xf]);
+                }
+                else
+                {
+                    put(c);
+                }
+            }
+            put('"');
+        }
+    }
+
+    Binary_writer sink_;
+    Text_options options_;
+    std::unique_ptr<char[]> buffer_;
+    std::size_t used_ = 0;
+    std::string scratch_;
+    std::size_t elements_ = 0;
+    bool begun_ = false;
+    bool finished_ = false;
+};
+
+#endif
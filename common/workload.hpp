@@ -0,0 +1,125 @@
+#ifndef DSA_WORKLOAD_HPP
+#define DSA_WORKLOAD_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+// Seeded key generators used by the benchmarks and the stress tests.
+// The same seed always gives the same keys, so results can be
+// compared between versions of the containers.
+
+enum class Distribution
+{
+    uniform,    // independent random keys
+    sorted,     // the uniform keys in increasing order
+    reversed,   // the uniform keys in decreasing order
+    zipfian,    // a few hot keys make up most of the sequence
+    duplicate_heavy // every key is one of about n/16 distinct values
+};
+
+inline const char* distribution_name(Distribution d)
+{
+    switch(d)
+    {
+        case Distribution::uniform: return "uniform";
+        case Distribution::sorted: return "sorted";
+        case Distribution::reversed: return "reversed";
+        case Distribution::zipfian: return "zipfian";
+        case Distribution::duplicate_heavy: return "duplicate_heavy";
+    }
+    return "unknown";
+}
+
+// Draws ranks 0..n-1 where rank r has probability proportional
+// to 1 / (r+1)^skew.  Sampling is a binary search in the
+// cumulative distribution, which is built once in O(n).
+class Zipf_distribution
+{
+public:
+    explicit Zipf_distribution(std::size_t n, double skew = 0.99)
+        : cdf_(std::max<std::size_t>(n, 1))
+    {
+        double sum = 0;
+        for(std::size_t r = 0; r < cdf_.size(); ++r)
+        {
+            sum += 1.0 / std::pow(static_cast<double>(r + 1), skew);
+            cdf_[r] = sum;
+        }
+        for(double& c : cdf_)
+        {
+            c /= sum;
+        }
+    }
+
+    template <typename Generator>
+    std::size_t operator()(Generator& gen)
+    {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(gen);
+        auto it = std::lower_bound(cdf_.begin(), cdf_.end(), u);
+        return std::min<std::size_t>(it - cdf_.begin(), cdf_.size() - 1);
+    }
+
+private:
+    std::vector<double> cdf_;
+};
+
+// n integer keys drawn according to d
+// Zipfian ranks are scrambled so that the hot keys are spread
+// over the key space rather than being the smallest ones.
+inline std::vector<int> make_keys(Distribution d, std::size_t n, std::uint64_t seed)
+{
+    std::mt19937_64 mt(seed);
+    std::vector<int> keys(n);
+    if(d == Distribution::zipfian)
+    {
+        Zipf_distribution zipf(n);
+        for(int& k : keys)
+        {
+            k = static_cast<int>(static_cast<std::uint32_t>(zipf(mt) * 2654435761u));
+        }
+        return keys;
+    }
+    if(d == Distribution::duplicate_heavy)
+    {
+        std::uniform_int_distribution<std::size_t> pool(0, n / 16);
+        for(int& k : keys)
+        {
+            k = static_cast<int>(static_cast<std::uint32_t>(pool(mt) * 2654435761u));
+        }
+        return keys;
+    }
+    for(int& k : keys)
+    {
+        k = static_cast<int>(static_cast<std::uint32_t>(mt()));
+    }
+    if(d == Distribution::sorted)
+    {
+        std::sort(keys.begin(), keys.end());
+    }
+    else if(d == Distribution::reversed)
+    {
+        std::sort(keys.rbegin(), keys.rend());
+    }
+    return keys;
+}
+
+// The same keys as make_keys written as fixed width strings
+// long enough not to fit in the small string buffer
+inline std::vector<std::string> make_string_keys(Distribution d, std::size_t n, std::uint64_t seed)
+{
+    std::vector<int> keys = make_keys(d, n, seed);
+    std::vector<std::string> strings;
+    strings.reserve(n);
+    for(int k : keys)
+    {
+        std::string digits = std::to_string(static_cast<std::uint32_t>(k));
+        strings.push_back("key:" + std::string(12 - digits.size(), '0') + digits);
+    }
+    return strings;
+}
+
+#endif